@@ -0,0 +1,176 @@
+#include <deque.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <numeric>
+#include <random>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// Deque против std::deque на int. В каждой строке - наносекунд на элемент (операцию).
+// queue: kCount раз PushBack, затем столько же PopFront.
+// boundary: в очереди на элемент меньше, чем вмещает блок, kCount / 2 раз две вставки
+// в конец и два удаления оттуда; каждый раз конец переходит в новый блок и обратно.
+// append: kCount элементов из вектора одним вызовом.
+// sort: std::sort kCount случайных чисел.
+// index: сумма kCount элементов по случайным индексам среди первых kIndexRange через
+// operator[]; эти элементы помещаются в кеш процессора, так что измеряется сам подсчет адреса.
+// scan: сумма всех элементов по индексам подряд.
+// segments: та же сумма через ForEachSegment у Deque и через итераторы у std::deque.
+// Запускать в Release.
+
+namespace {
+
+constexpr int kCount = 10'000'000;
+constexpr int kIndexRange = 1 << 16;
+
+// Обертка, чтобы std::deque и Deque вызывались одинаково.
+class StdDeque : public std::deque<int> {
+public:
+    void PushBack(int value) {
+        push_back(value);
+    }
+
+    void PopBack() {
+        pop_back();
+    }
+
+    void PopFront() {
+        pop_front();
+    }
+
+    void Append(const std::vector<int>& values) {
+        insert(end(), values.begin(), values.end());
+    }
+};
+
+template <class Function>
+double Measure(Function function) {
+    auto start = std::chrono::steady_clock::now();
+    function();
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / kCount;
+}
+
+// Чтобы компилятор не выбросил результат.
+int64_t sink = 0;
+
+template <class D>
+double Queue() {
+    D deque;
+    return Measure([&deque] {
+        for (auto i = 0; i < kCount; ++i) {
+            deque.PushBack(i);
+        }
+        for (auto i = 0; i < kCount; ++i) {
+            sink += deque[0];
+            deque.PopFront();
+        }
+    });
+}
+
+template <class D>
+double Boundary() {
+    D deque;
+    for (auto i = 0; i < 127; ++i) {
+        deque.PushBack(i);
+    }
+    return Measure([&deque] {
+        for (auto i = 0; i < kCount / 2; ++i) {
+            deque.PushBack(i);
+            deque.PushBack(i);
+            deque.PopBack();
+            deque.PopBack();
+        }
+    });
+}
+
+template <class D>
+double Append(const std::vector<int>& values) {
+    D deque;
+    return Measure([&deque, &values] {
+        deque.Append(values);
+        sink += deque[kCount / 2];
+    });
+}
+
+template <class D>
+double Sort(const std::vector<int>& values) {
+    D deque;
+    deque.Append(values);
+    return Measure([&deque] {
+        std::sort(deque.begin(), deque.end());
+        sink += deque[kCount / 2];
+    });
+}
+
+template <class D>
+double Index(const std::vector<int>& values, const std::vector<int>& indices) {
+    D deque;
+    deque.Append(values);
+    return Measure([&deque, &indices] {
+        int64_t sum = 0;
+        for (auto index : indices) {
+            sum += deque[index];
+        }
+        sink += sum;
+    });
+}
+
+template <class D>
+double Scan(const std::vector<int>& values) {
+    D deque;
+    deque.Append(values);
+    return Measure([&deque] {
+        int64_t sum = 0;
+        for (auto i = 0; i < kCount; ++i) {
+            sum += deque[i];
+        }
+        sink += sum;
+    });
+}
+
+template <class D>
+double Segments(const std::vector<int>& values) {
+    D deque;
+    deque.Append(values);
+    return Measure([&deque] {
+        int64_t sum = 0;
+        if constexpr (std::is_same_v<D, StdDeque>) {
+            sum = std::accumulate(deque.begin(), deque.end(), sum);
+        } else {
+            deque.ForEachSegment([&sum](std::span<const int> segment) {
+                sum = std::accumulate(segment.begin(), segment.end(), sum);
+            });
+        }
+        sink += sum;
+    });
+}
+
+}  // namespace
+
+int main() {
+    std::vector<int> values(kCount);
+    std::mt19937 gen{32'768};
+    std::ranges::generate(values, gen);
+    std::vector<int> indices(kCount);
+    std::ranges::generate(indices, [&gen] { return static_cast<int>(gen() % kIndexRange); });
+
+    std::printf("%-10s %12s %12s\n", "ns/op", "Deque", "std::deque");
+    std::printf("%-10s %12.2f %12.2f\n", "queue", Queue<Deque<int>>(), Queue<StdDeque>());
+    std::printf("%-10s %12.2f %12.2f\n", "boundary", Boundary<Deque<int>>(),
+                Boundary<StdDeque>());
+    std::printf("%-10s %12.2f %12.2f\n", "append", Append<Deque<int>>(values),
+                Append<StdDeque>(values));
+    std::printf("%-10s %12.2f %12.2f\n", "sort", Sort<Deque<int>>(values), Sort<StdDeque>(values));
+    std::printf("%-10s %12.2f %12.2f\n", "index", Index<Deque<int>>(values, indices),
+                Index<StdDeque>(values, indices));
+    std::printf("%-10s %12.2f %12.2f\n", "scan", Scan<Deque<int>>(values), Scan<StdDeque>(values));
+    std::printf("%-10s %12.2f %12.2f\n", "segments", Segments<Deque<int>>(values),
+                Segments<StdDeque>(values));
+    return sink == 0;
+}
@@ -1,253 +1,288 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
+#include <compare>
 #include <cstddef>
 #include <initializer_list>
-#include <cstring>
-#include <new>
-#include <stdlib.h>
-#include <algorithm>
-
-constexpr size_t kBlockSize = 128;
-
+#include <iterator>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+constexpr size_t kBlockBytes = 512;
+
+// Элементы лежат в блоках по kBlockSize штук, указатели на блоки - в кольцевом массиве
+// blocks_. Элемент с индексом i находится на позиции first_ + i этого кольца, если
+// считать в элементах. Блоки не переезжают, поэтому ссылки на элементы остаются
+// валидными при вставках и удалениях на концах.
+//
+// И размер блока, и число блоков в кольце - степени двойки, поэтому позиция элемента
+// в кольце, номер блока и место в блоке считаются маской и сдвигом, без деления.
+//
+// Опустевший блок не освобождается сразу, а попадает в небольшой кеш free_blocks_,
+// откуда его берет следующий новый блок. Так очередь, которая колеблется около границы
+// блока, не ходит в аллокатор на каждой вставке.
+template <class T = int>
 class Deque {
-    class Block {
+    static constexpr size_t kBlockSize =
+        std::bit_floor(std::max<size_t>(kBlockBytes / sizeof(T), 1));
+    static constexpr size_t kBlockShift = std::countr_zero(kBlockSize);
+    static constexpr size_t kBlockMask = kBlockSize - 1;
+    static constexpr size_t kFreeBlockCacheSize = 4;
+
+public:
+    template <bool kConst>
+    class Iterator {
     public:
-        Block() = default;
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<kConst, const T*, T*>;
+        using reference = std::conditional_t<kConst, const T&, T&>;
 
-        Block(size_t size) : begin_(0), end_(size) {
-            data_ = static_cast<int*>(calloc(kBlockSize, sizeof(int)));
+        Iterator() = default;
+
+        Iterator(std::conditional_t<kConst, const Deque*, Deque*> deque, size_t index)
+            : deque_(deque), index_(index) {
         }
 
-        Block(const Block& other) : begin_(other.begin_), end_(other.end_) {
-            if (other.data_) {
-                data_ = static_cast<int*>(calloc(kBlockSize, sizeof(int)));
-                std::memcpy(data_, other.data_, sizeof(int) * kBlockSize);
-            }
+        operator Iterator<true>() const
+            requires(!kConst)
+        {
+            return {deque_, index_};
         }
 
-        Block(Block&& other) : begin_(other.begin_), end_(other.end_) {
-            data_ = other.data_;
-            other.data_ = nullptr;
+        reference operator*() const {
+            return (*deque_)[index_];
         }
 
-        ~Block() {
-            free(data_);
+        pointer operator->() const {
+            return &(*deque_)[index_];
         }
 
-        bool PushFront(int value) {
-            if (!data_) {
-                data_ = static_cast<int*>(calloc(kBlockSize, sizeof(int)));
-                begin_ = end_ = kBlockSize;
-            }
+        reference operator[](difference_type n) const {
+            return (*deque_)[index_ + n];
+        }
 
-            if (begin_ > 0) {
-                *(data_ + begin_ - 1) = value;
-                --begin_;
-                return true;
-            } else {
-                return false;
-            }
+        Iterator& operator++() {
+            ++index_;
+            return *this;
         }
 
-        bool PushBack(int value) {
-            if (!data_) {
-                data_ = static_cast<int*>(calloc(kBlockSize, sizeof(int)));
-                begin_ = end_ = 0;
-            }
+        Iterator operator++(int) {
+            auto tmp = *this;
+            ++index_;
+            return tmp;
+        }
 
-            if (end_ < kBlockSize) {
-                *(data_ + end_) = value;
-                ++end_;
-                return true;
-            } else {
-                return false;
-            }
+        Iterator& operator--() {
+            --index_;
+            return *this;
         }
 
-        void PopFront() {
-            if (++begin_ == end_) {
-                free(data_);
-                data_ = nullptr;
-            }
+        Iterator operator--(int) {
+            auto tmp = *this;
+            --index_;
+            return tmp;
         }
 
-        void PopBack() {
-            if (--end_ == begin_) {
-                free(data_);
-                data_ = nullptr;
-            }
+        Iterator& operator+=(difference_type n) {
+            index_ += n;
+            return *this;
         }
 
-        int& operator[](size_t index) {
-            return *(data_ + begin_ + index);
+        Iterator& operator-=(difference_type n) {
+            index_ -= n;
+            return *this;
         }
 
-        const int& operator[](size_t index) const {
-            return *(data_ + begin_ + index);
+        friend Iterator operator+(Iterator it, difference_type n) {
+            return it += n;
         }
 
-        size_t Size() const {
-            return end_ - begin_;
+        friend Iterator operator+(difference_type n, Iterator it) {
+            return it += n;
         }
 
-        bool IsEmpty() const {
-            return data_ == nullptr;
+        friend Iterator operator-(Iterator it, difference_type n) {
+            return it -= n;
         }
 
-        size_t BeginIdx() const {
-            return begin_;
+        friend difference_type operator-(const Iterator& a, const Iterator& b) {
+            return static_cast<difference_type>(a.index_ - b.index_);
+        }
+
+        bool operator==(const Iterator& other) const {
+            return index_ == other.index_;
+        }
+
+        std::strong_ordering operator<=>(const Iterator& other) const {
+            return index_ <=> other.index_;
         }
 
     private:
-        int* data_ = nullptr;
-        size_t begin_;
-        size_t end_;
+        std::conditional_t<kConst, const Deque*, Deque*> deque_ = nullptr;
+        size_t index_ = 0;
     };
 
-public:
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
     Deque() {
     }
 
-    Deque(const Deque& other) {
-        size_ = other.size_;
-        block_cnt_ = other.block_cnt_;
-        left_block_ = other.left_block_;
-        if (other.data_) {
-            data_ = new Block*[block_cnt_];
-            for (size_t i = 0; i < block_cnt_; ++i) {
-                data_[i] = new Block(*other.data_[i]);
-            }
-        }
+    // Конструкторы, которые создают элементы, сначала делегируют пустому: если элемент
+    // бросит исключение, деструктор освободит уже созданные элементы и блоки.
+    Deque(const Deque& other) : Deque() {
+        ReserveBack(other.size_);
+        other.ForEachSegment([this](std::span<const T> segment) {
+            AppendBlocks(segment.size(), [&segment](T* begin, size_t count) {
+                std::uninitialized_copy_n(segment.data(), count, begin);
+                segment = segment.subspan(count);
+            });
+        });
     }
 
-    Deque(Deque&& other) {
-        size_ = other.size_;
-        block_cnt_ = other.block_cnt_;
-        left_block_ = other.left_block_;
-        data_ = other.data_;
-        other.size_ = 0;
-        other.block_cnt_ = 0;
-        other.data_ = nullptr;
-    }
-
-    explicit Deque(size_t size) {
-        if (size > 0) {
-            block_cnt_ = (size - 1) / kBlockSize + 1;
-            size_ = size;
-            data_ = new Block*[block_cnt_];
-            left_block_ = 0;
-            for (size_t i = 0; i < block_cnt_; ++i) {
-                if (kBlockSize * (i + 1) <= size) {
-                    data_[i] = new Block(kBlockSize);
-                } else {
-                    data_[i] = new Block(size - kBlockSize * i);
-                }
-            }
-        }
+    Deque(Deque&& other) noexcept {
+        Swap(other);
     }
 
-    Deque(std::initializer_list<int> list) : Deque(list.size()) {
-        for (size_t i = 0; int elem : list) {
-            (*this)[i++] = elem;
-        }
+    explicit Deque(size_t size) : Deque() {
+        AppendBlocks(size, [](T* begin, size_t count) {
+            std::uninitialized_value_construct_n(begin, count);
+        });
+    }
+
+    Deque(std::initializer_list<T> list) : Deque() {
+        Append(list);
     }
 
-    const Deque& operator=(const Deque& other) {
+    Deque& operator=(const Deque& other) {
         if (this != &other) {
-            Clear();
-            size_ = other.size_;
-            block_cnt_ = other.block_cnt_;
-            left_block_ = other.left_block_;
-            if (other.data_) {
-                data_ = new Block*[block_cnt_];
-                for (size_t i = 0; i < block_cnt_; ++i) {
-                    data_[i] = new Block(*other.data_[i]);
-                }
-            }
+            Deque copy(other);
+            Swap(copy);
         }
-
         return *this;
     }
 
-    const Deque& operator=(Deque&& other) {
+    Deque& operator=(Deque&& other) noexcept {
         if (this != &other) {
-            Clear();
-            size_ = other.size_;
-            block_cnt_ = other.block_cnt_;
-            left_block_ = other.left_block_;
-            data_ = other.data_;
-            other.size_ = 0;
-            other.block_cnt_ = 0;
-            other.data_ = nullptr;
+            Deque moved(std::move(other));
+            Swap(moved);
         }
-
         return *this;
     }
 
     ~Deque() {
         Clear();
+        for (size_t i = 0; i < free_block_cnt_; ++i) {
+            DeallocateBlock(free_blocks_[i]);
+        }
     }
 
-    void Swap(Deque& other) {
-        std::swap(data_, other.data_);
-        std::swap(left_block_, other.left_block_);
+    void Swap(Deque& other) noexcept {
+        std::swap(blocks_, other.blocks_);
         std::swap(block_cnt_, other.block_cnt_);
+        std::swap(first_, other.first_);
         std::swap(size_, other.size_);
+        std::swap(free_blocks_, other.free_blocks_);
+        std::swap(free_block_cnt_, other.free_block_cnt_);
     }
 
-    void PushBack(int value) {
-        size_t block_idx = BlockIdx(size_);
-        if (!data_ || !data_[block_idx]->PushBack(value)) {
-            Realloc();
-            PushBack(value);
-        } else {
-            ++size_;
-        }
+    void PushBack(T value) {
+        ReserveBack(1);
+        std::construct_at(Slot(size_), std::move(value));
+        ++size_;
     }
 
     void PopBack() {
-        size_t block_idx = BlockIdx(size_ - 1);
-        data_[block_idx]->PopBack();
+        auto position = Position(size_ - 1);
+        std::destroy_at(&blocks_[position >> kBlockShift][position & kBlockMask]);
         if (!--size_) {
-            left_block_ = 0;
+            ReleaseBlock(position >> kBlockShift);
+            first_ = 0;
+        } else if ((position & kBlockMask) == 0) {
+            ReleaseBlock(position >> kBlockShift);
         }
     }
 
-    void PushFront(int value) {
-        size_t block_idx = BlockIdx(-1);
-        if (!data_ || !data_[block_idx]->PushFront(value)) {
-            Realloc();
-            PushFront(value);
-        } else {
-            left_block_ = block_idx;
-            ++size_;
+    void PushFront(T value) {
+        if ((first_ & kBlockMask) == 0 && UsedBlocks(size_) == block_cnt_) {
+            Grow(block_cnt_ + 1);
         }
+        std::construct_at(Slot(Capacity() - 1), std::move(value));
+        first_ = Position(Capacity() - 1);
+        ++size_;
     }
 
     void PopFront() {
-        size_t block_idx = BlockIdx(0);
-        data_[block_idx]->PopFront();
-        if (data_[block_idx]->IsEmpty()) {
-            left_block_ = (left_block_ + 1) % block_cnt_;
+        auto position = first_;
+        std::destroy_at(&blocks_[position >> kBlockShift][position & kBlockMask]);
+        first_ = Position(1);
+        if (!--size_) {
+            ReleaseBlock(position >> kBlockShift);
+            first_ = 0;
+        } else if ((first_ & kBlockMask) == 0) {
+            ReleaseBlock(position >> kBlockShift);
         }
+    }
 
-        if (!--size_) {
-            left_block_ = 0;
+    // Добавляет элементы range в конец. Если размер range известен заранее, кольцо
+    // расширяется один раз, а элементы копируются сразу целыми кусками блоков.
+    template <std::ranges::input_range Range>
+    void Append(Range&& range) {
+        if constexpr (std::ranges::sized_range<Range>) {
+            auto it = std::ranges::begin(range);
+            AppendBlocks(std::ranges::size(range), [&it](T* begin, size_t count) {
+                it = std::ranges::uninitialized_copy_n(it, count, begin, begin + count).in;
+            });
+        } else {
+            for (auto&& element : range) {
+                PushBack(std::forward<decltype(element)>(element));
+            }
         }
     }
 
-    int& operator[](size_t index) {
-        const size_t block_idx = BlockIdx(index);
-        const size_t elem_idx =
-            (data_[left_block_]->BeginIdx() + index) % kBlockSize - data_[block_idx]->BeginIdx();
-        return (*data_[block_idx])[elem_idx];
+    T& operator[](size_t index) {
+        auto position = Position(index);
+        return blocks_[position >> kBlockShift][position & kBlockMask];
     }
 
-    const int& operator[](size_t index) const {
-        const size_t block_idx = BlockIdx(index);
-        const size_t elem_idx =
-            (data_[left_block_]->BeginIdx() + index) % kBlockSize - data_[block_idx]->BeginIdx();
-        return (*data_[block_idx])[elem_idx];
+    const T& operator[](size_t index) const {
+        auto position = Position(index);
+        return blocks_[position >> kBlockShift][position & kBlockMask];
+    }
+
+    // Вызывает function(std::span<T>) (у константной деки - std::span<const T>) для
+    // непрерывных кусков деки по порядку. Куски не длиннее блока, внутри куска элементы
+    // лежат подряд, так что обрабатывать их можно как обычный массив.
+    template <class Function>
+    void ForEachSegment(Function function) {
+        ForEachSegmentImpl(this, function);
+    }
+
+    template <class Function>
+    void ForEachSegment(Function function) const {
+        ForEachSegmentImpl(this, function);
+    }
+
+    iterator begin() {
+        return {this, 0};
+    }
+
+    iterator end() {
+        return {this, size_};
+    }
+
+    const_iterator begin() const {
+        return {this, 0};
+    }
+
+    const_iterator end() const {
+        return {this, size_};
     }
 
     size_t Size() const {
@@ -255,48 +290,119 @@ public:
     }
 
     void Clear() {
+        while (size_) {
+            PopBack();
+        }
+        // Блоки, которые остались пустыми после исключения в конструкторе элемента.
         for (size_t i = 0; i < block_cnt_; ++i) {
-            delete data_[i];
-            data_[i] = nullptr;
+            if (blocks_[i]) {
+                ReleaseBlock(i);
+            }
         }
-
-        delete[] data_;
-        data_ = nullptr;
-        size_ = 0;
+        delete[] blocks_;
+        blocks_ = nullptr;
         block_cnt_ = 0;
+        first_ = 0;
     }
 
 private:
-    void Realloc() {
-        const size_t new_block_cnt = block_cnt_ > 0 ? 2 * block_cnt_ : 1;
-        Block** new_data = new Block*[new_block_cnt];
-        for (size_t i = 0; i < new_block_cnt; ++i) {
-            if (i < block_cnt_) {
-                new_data[i] = data_[(left_block_ + i) % block_cnt_];
-            } else {
-                new_data[i] = new Block();
-            }
+    size_t Capacity() const {
+        return block_cnt_ << kBlockShift;
+    }
+
+    size_t Position(size_t index) const {
+        return (first_ + index) & (Capacity() - 1);
+    }
+
+    // Сколько блоков, начиная с блока первого элемента, займут count элементов.
+    size_t UsedBlocks(size_t count) const {
+        return ((first_ & kBlockMask) + count + kBlockMask) >> kBlockShift;
+    }
+
+    template <class Self, class Function>
+    static void ForEachSegmentImpl(Self* self, Function& function) {
+        using Segment = std::span<std::conditional_t<std::is_const_v<Self>, const T, T>>;
+        auto position = self->first_;
+        for (auto left = self->size_; left;) {
+            auto offset = position & kBlockMask;
+            auto count = std::min(left, kBlockSize - offset);
+            function(Segment{self->blocks_[position >> kBlockShift] + offset, count});
+            position = (position + count) & (self->Capacity() - 1);
+            left -= count;
+        }
+    }
+
+    // Ячейка для элемента с индексом index, в том числе за концами деки (индекс
+    // Capacity() - 1 - перед первым элементом); блок выделяется, если его нет.
+    T* Slot(size_t index) {
+        auto position = Position(index);
+        auto& block = blocks_[position >> kBlockShift];
+        if (!block) {
+            block = AllocateBlock();
+        }
+        return &block[position & kBlockMask];
+    }
+
+    // Конец кольца не должен заходить в блок первого элемента, поэтому считаются блоки
+    // от него, а не свободные ячейки.
+    void ReserveBack(size_t count) {
+        if (UsedBlocks(size_ + count) > block_cnt_) {
+            Grow(UsedBlocks(size_ + count));
+        }
+    }
+
+    // Кладет в конец count элементов: fill(begin, n) создает n элементов подряд с begin.
+    template <class Fill>
+    void AppendBlocks(size_t count, Fill fill) {
+        ReserveBack(count);
+        while (count) {
+            auto offset = Position(size_) & kBlockMask;
+            auto chunk = std::min(count, kBlockSize - offset);
+            fill(Slot(size_), chunk);
+            size_ += chunk;
+            count -= chunk;
         }
+    }
 
-        delete[] data_;
-        data_ = new_data;
-        left_block_ = 0;
+    // Перекладывает указатели в кольцо хотя бы на min_block_cnt блоков (с округлением
+    // до степени двойки) так, что блок первого элемента становится нулевым.
+    void Grow(size_t min_block_cnt) {
+        auto new_block_cnt = std::bit_ceil(std::max(2 * block_cnt_, min_block_cnt));
+        auto new_blocks = new T*[new_block_cnt]();
+        auto first_block = first_ >> kBlockShift;
+        for (size_t i = 0; i < block_cnt_; ++i) {
+            new_blocks[i] = blocks_[(first_block + i) & (block_cnt_ - 1)];
+        }
+        delete[] blocks_;
+        blocks_ = new_blocks;
         block_cnt_ = new_block_cnt;
+        first_ &= kBlockMask;
+    }
+
+    T* AllocateBlock() {
+        if (free_block_cnt_) {
+            return free_blocks_[--free_block_cnt_];
+        }
+        return std::allocator<T>{}.allocate(kBlockSize);
+    }
+
+    void DeallocateBlock(T* block) {
+        std::allocator<T>{}.deallocate(block, kBlockSize);
     }
 
-    size_t BlockIdx(int64_t elem_idx) const {
-        if (!size_) {
-            return 0;
-        } else if (elem_idx >= 0) {
-            return (left_block_ + (data_[left_block_]->BeginIdx() + elem_idx) / kBlockSize) %
-                   block_cnt_;
+    void ReleaseBlock(size_t block_idx) {
+        if (free_block_cnt_ < kFreeBlockCacheSize) {
+            free_blocks_[free_block_cnt_++] = blocks_[block_idx];
         } else {
-            return BlockIdx(block_cnt_ * kBlockSize + elem_idx);
+            DeallocateBlock(blocks_[block_idx]);
         }
+        blocks_[block_idx] = nullptr;
     }
 
-    Block** data_ = nullptr;
-    size_t size_ = 0;
+    T** blocks_ = nullptr;
     size_t block_cnt_ = 0;
-    size_t left_block_;
+    size_t first_ = 0;
+    size_t size_ = 0;
+    T* free_blocks_[kFreeBlockCacheSize] = {};
+    size_t free_block_cnt_ = 0;
 };
@@ -1,16 +1,23 @@
 #include <deque.h>
 #include <util.h>
 
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <memory>
 #include <string>
 #include <vector>
 #include <random>
 #include <deque>
 #include <ranges>
 #include <cstddef>
+#include <numeric>
+#include <span>
+#include <stdexcept>
 
 #include <catch2/catch_test_macros.hpp>
 
-void Check(const Deque& actual, const std::vector<int>& expected) {
+void Check(const Deque<int>& actual, const std::vector<int>& expected) {
     REQUIRE(actual.Size() == expected.size());
     for (auto i : std::views::iota(size_t{0}, expected.size())) {
         if (actual[i] != expected[i]) {
@@ -19,7 +26,7 @@ void Check(const Deque& actual, const std::vector<int>& expected) {
     }
 }
 
-void CheckEq(const Deque& a, const Deque& b) {
+void CheckEq(const Deque<int>& a, const Deque<int>& b) {
     REQUIRE(a.Size() == b.Size());
     for (auto i : std::views::iota(size_t{0}, a.Size())) {
         if (a[i] != b[i]) {
@@ -215,7 +222,7 @@ TEST_CASE("Stress") {
     }
 }
 
-void CheckEmptyCorrectness(void (Deque::*push)(int), void (Deque::*pop)()) {
+void CheckEmptyCorrectness(void (Deque<int>::*push)(int), void (Deque<int>::*pop)()) {
     constexpr auto kTestSize = 1'000'000;
 
     Deque a;
@@ -232,10 +239,10 @@ TEST_CASE("Empty correctness") {
     // There are some ways to make deque empty
     // We should test them all
     // In some ways we can cause memory leak
-    CheckEmptyCorrectness(&Deque::PushBack, &Deque::PopBack);
-    CheckEmptyCorrectness(&Deque::PushBack, &Deque::PopFront);
-    CheckEmptyCorrectness(&Deque::PushFront, &Deque::PopBack);
-    CheckEmptyCorrectness(&Deque::PushFront, &Deque::PopFront);
+    CheckEmptyCorrectness(&Deque<int>::PushBack, &Deque<int>::PopBack);
+    CheckEmptyCorrectness(&Deque<int>::PushBack, &Deque<int>::PopFront);
+    CheckEmptyCorrectness(&Deque<int>::PushFront, &Deque<int>::PopBack);
+    CheckEmptyCorrectness(&Deque<int>::PushFront, &Deque<int>::PopFront);
 }
 
 TEST_CASE("Fast self-assignment") {
@@ -250,12 +257,209 @@ TEST_CASE("Fast self-assignment") {
     Check(a, {kRange.begin(), kRange.end()});
 }
 
+namespace {
+
+struct Counted {
+    static inline int alive = 0;
+    // Сколько еще объектов можно создать, прежде чем конструктор бросит исключение;
+    // отрицательное значение - без ограничения.
+    static inline int constructions_left = -1;
+
+    Counted() : Counted(0) {
+    }
+
+    explicit Counted(int value) : value(value) {
+        Construct();
+    }
+
+    Counted(const Counted& other) : value(other.value) {
+        Construct();
+    }
+
+    ~Counted() {
+        --alive;
+    }
+
+    static void Construct() {
+        if (!constructions_left) {
+            throw std::runtime_error{"construction failed"};
+        }
+        --constructions_left;
+        ++alive;
+    }
+
+    int value;
+};
+
+}  // namespace
+
+TEST_CASE("Other element types") {
+    Deque<std::string> a = {"b", "c"};
+    a.PushFront("a");
+    a.PushBack(std::string(100, 'd'));
+    REQUIRE(a.Size() == 4);
+    REQUIRE(a[0] == "a");
+    REQUIRE(a[3] == std::string(100, 'd'));
+
+    Deque<std::unique_ptr<int>> b;
+    for (auto i = 0; i < 1'000; ++i) {
+        b.PushFront(std::make_unique<int>(i));
+    }
+    REQUIRE(*b[0] == 999);
+    b.PopFront();
+    REQUIRE(*b[0] == 998);
+
+    {
+        Deque<Counted> c;
+        for (auto i = 0; i < 1'000; ++i) {
+            c.PushBack(Counted{i});
+            c.PushFront(Counted{-i});
+        }
+        auto d = c;
+        REQUIRE(Counted::alive == 4'000);
+        for (auto i = 0; i < 500; ++i) {
+            c.PopBack();
+            d.PopFront();
+        }
+        REQUIRE(Counted::alive == 3'000);
+    }
+    REQUIRE(Counted::alive == 0);
+
+    // Исключение из конструктора элемента не оставляет ни элементов, ни блоков.
+    Counted::constructions_left = 300;
+    REQUIRE_THROWS_AS(Deque<Counted>(1'000), std::runtime_error);
+    REQUIRE(Counted::alive == 0);
+    Counted::constructions_left = -1;
+    {
+        Deque<Counted> c(1'000);
+        Counted::constructions_left = 700;
+        REQUIRE_THROWS_AS(Deque<Counted>{c}, std::runtime_error);
+        // Два элемента списка создаются до деки, затем копируется только первый.
+        Counted::constructions_left = 3;
+        REQUIRE_THROWS_AS((Deque<Counted>{Counted{1}, Counted{2}}), std::runtime_error);
+        Counted::constructions_left = -1;
+        REQUIRE(Counted::alive == 1'000);
+    }
+    REQUIRE(Counted::alive == 0);
+}
+
+TEST_CASE("Iterators") {
+    STATIC_CHECK(std::random_access_iterator<Deque<int>::iterator>);
+    STATIC_CHECK(std::random_access_iterator<Deque<int>::const_iterator>);
+    STATIC_CHECK(std::ranges::random_access_range<const Deque<int>>);
+
+    std::mt19937 gen{4'242};
+    Deque<int> a;
+    std::vector<int> expected;
+    for (auto i = 0; i < 1'000; ++i) {
+        auto value = static_cast<int>(gen() % 1'000);
+        if (i % 3) {
+            a.PushFront(value);
+            expected.insert(expected.begin(), value);
+        } else {
+            a.PushBack(value);
+            expected.push_back(value);
+        }
+    }
+    REQUIRE(std::equal(a.begin(), a.end(), expected.begin(), expected.end()));
+    REQUIRE(a.end() - a.begin() == 1'000);
+
+    std::sort(a.begin(), a.end());
+    std::ranges::sort(expected);
+    Check(a, expected);
+
+    std::ranges::sort(a, std::greater{});
+    const auto& r = a;
+    std::vector<int> reversed(r.begin(), r.end());
+    REQUIRE(std::ranges::equal(reversed | std::views::reverse, expected));
+
+    Deque<int>::const_iterator it = a.begin() + 10;
+    REQUIRE(it[-10] == a[0]);
+    REQUIRE(*(5 + it) == a[15]);
+    REQUIRE(it > a.begin());
+}
+
+TEST_CASE("Append") {
+    Deque<int> a = {3, 4};
+    a.PushFront(2);
+    a.PushFront(1);
+
+    std::vector<int> v(300);
+    std::iota(v.begin(), v.end(), 5);
+    a.Append(v);
+    REQUIRE(a.Size() == 304);
+    for (auto i = 0; i < 304; ++i) {
+        REQUIRE(a[i] == i + 1);
+    }
+
+    a.Append(std::list{1, 2, 3});
+    a.Append(std::views::iota(0, 10) | std::views::filter([](int x) { return x % 2; }));
+    Check(a, [&] {
+        std::vector<int> expected(304);
+        std::iota(expected.begin(), expected.end(), 1);
+        expected.insert(expected.end(), {1, 2, 3, 1, 3, 5, 7, 9});
+        return expected;
+    }());
+
+    Deque<std::string> b;
+    b.Append(std::vector<std::string>{"a", "b"});
+    b.Append(b);
+    REQUIRE(b.Size() == 4);
+    REQUIRE(b[3] == "b");
+}
+
+TEST_CASE("Segments") {
+    Deque<int> a;
+    for (auto i = 0; i < 1'000; ++i) {
+        a.PushBack(i);
+        a.PushFront(-i - 1);
+    }
+    for (auto i = 0; i < 100; ++i) {
+        a.PopFront();
+    }
+
+    std::vector<int> elements;
+    a.ForEachSegment([&elements](std::span<int> segment) {
+        REQUIRE_FALSE(segment.empty());
+        REQUIRE(segment.size() <= 128);
+        for (auto& x : segment) {
+            elements.push_back(x);
+            x *= 2;
+        }
+    });
+    REQUIRE(std::ranges::equal(elements, std::views::iota(-900, 1'000)));
+
+    const auto& r = a;
+    int64_t sum = 0;
+    auto segments = 0;
+    r.ForEachSegment([&sum, &segments](std::span<const int> segment) {
+        sum = std::accumulate(segment.begin(), segment.end(), sum);
+        ++segments;
+    });
+    REQUIRE(sum == 2 * (999 * 1'000 / 2 - 900 * 901 / 2));
+    // Первый элемент с середины блока.
+    REQUIRE(segments == 16);
+
+    Deque<int>{}.ForEachSegment([](std::span<int>) { FAIL("empty deque has segments"); });
+}
+
+TEST_CASE("Blocks are reused") {
+    Deque a(128);
+    a.PushBack(1);
+    auto* address = &a[128];
+    for (auto i = 0; i < 1'000; ++i) {
+        a.PopBack();
+        a.PushBack(i);
+        REQUIRE(&a[128] == address);
+    }
+}
+
 #ifdef __linux__
 
 TEST_CASE("Memory usage", "[.][memory][no_asan]") {
     {
         auto before = GetMemoryUsage();
-        std::vector<Deque> v(1'000);
+        std::vector<Deque<int>> v(1'000);
         for (auto& d : v) {
             for (auto i : std::views::iota(0, 200)) {
                 d.PushBack(i);
@@ -0,0 +1,110 @@
+#include <concurrent_lru_cache.h>
+#include <lru_cache.h>
+#include <pooled_lru_cache.h>
+#include <util.h>
+
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Пропускная способность кешей при одновременных обращениях из нескольких потоков.
+// Каждый поток делает kOperations обращений к общему кешу: 90% Get, 10% Set, ключи
+// выбираются случайно из вдвое большего емкости множества. Число потоков удваивается до
+// аргумента, по умолчанию - до числа ядер. Однопоточные кеши сравниваются на одном потоке.
+// Запускать в Release.
+
+namespace {
+
+constexpr size_t kCapacity = 100'000;
+constexpr size_t kKeys = 2 * kCapacity;
+constexpr int kOperations = 1'000'000;
+
+// Исходный LruCache под одной блокировкой.
+class MutexLruCache {
+public:
+    explicit MutexLruCache(size_t max_size) : cache_{max_size} {
+    }
+
+    void Set(const std::string& key, const std::string& value) {
+        std::lock_guard lock{mutex_};
+        cache_.Set(key, value);
+    }
+
+    bool Get(const std::string& key, std::string* value) {
+        std::lock_guard lock{mutex_};
+        return cache_.Get(key, value);
+    }
+
+private:
+    std::mutex mutex_;
+    LruCache cache_;
+};
+
+struct Operation {
+    std::string key;
+    bool is_set;
+};
+
+std::vector<Operation> MakeOperations(uint32_t seed) {
+    RandomGenerator rnd{seed};
+    std::vector<Operation> operations(kOperations);
+    for (auto& operation : operations) {
+        operation.key = std::to_string(rnd.GenInt<size_t>(0, kKeys - 1));
+        operation.is_set = rnd.GenInt(0, 9) == 0;
+    }
+    return operations;
+}
+
+// Миллионов операций в секунду на все потоки вместе.
+template <class Cache>
+double Run(const std::vector<std::vector<Operation>>& workload) {
+    Cache cache{kCapacity};
+    for (size_t i = 0; i < kKeys; i += 2) {
+        cache.Set(std::to_string(i), "value");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (const auto& operations : workload) {
+        threads.emplace_back([&cache, &operations] {
+            std::string value;
+            for (const auto& [key, is_set] : operations) {
+                if (is_set) {
+                    cache.Set(key, key);
+                } else {
+                    cache.Get(key, &value);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return workload.size() * kOperations / elapsed.count() / 1e6;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    auto max_threads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1]))
+                                : std::max(std::thread::hardware_concurrency(), 1u);
+    std::printf("%-8s %14s %14s\n", "threads", "mutex Mops/s", "sharded Mops/s");
+    for (auto threads = 1u; threads <= max_threads; threads *= 2) {
+        std::vector<std::vector<Operation>> workload;
+        for (auto i = 0u; i < threads; ++i) {
+            workload.push_back(MakeOperations(i));
+        }
+        std::printf("%-8u %14.2f %14.2f\n", threads, Run<MutexLruCache>(workload),
+                    Run<ConcurrentLruCache>(workload));
+    }
+
+    std::vector<std::vector<Operation>> workload = {MakeOperations(0)};
+    std::printf("\n%-16s %14s\n", "single thread", "Mops/s");
+    std::printf("%-16s %14.2f\n", "LruCache", Run<LruCache>(workload));
+    std::printf("%-16s %14.2f\n", "PooledLruCache",
+                Run<PooledLruCache<std::string, std::string>>(workload));
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Возраст вытесненных записей по степеням двойки в миллисекундах: в корзине 0 записи
+// моложе 1 мс, в корзине i - от 2^(i-1) до 2^i мс, в последней - все более старые.
+constexpr size_t kEvictionAgeBuckets = 32;
+
+// Возраст при вытеснении запоминается только у каждой kAgeSampleInterval-й вставленной
+// записи, чтобы остальные вставки и вытеснения не спрашивали часы.
+constexpr uint64_t kAgeSampleInterval = 16;
+
+// Снимок счетчиков кеша.
+struct CacheMetrics {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t inserts = 0;
+    uint64_t updates = 0;
+    uint64_t evictions = 0;
+    uint64_t expirations = 0;
+    // Сколько записей и какой их суммарный вес в кеше в момент снимка.
+    uint64_t size = 0;
+    uint64_t weight = 0;
+    std::array<uint64_t, kEvictionAgeBuckets> eviction_age{};
+
+    CacheMetrics& operator+=(const CacheMetrics& other) {
+        hits += other.hits;
+        misses += other.misses;
+        inserts += other.inserts;
+        updates += other.updates;
+        evictions += other.evictions;
+        expirations += other.expirations;
+        size += other.size;
+        weight += other.weight;
+        for (size_t i = 0; i < kEvictionAgeBuckets; ++i) {
+            eviction_age[i] += other.eviction_age[i];
+        }
+        return *this;
+    }
+
+    // Строка "имя значение" на каждый счетчик, затем по строке на непустую корзину
+    // возраста: "eviction_age_ms <граница корзины> число".
+    std::string ToText() const {
+        std::string text;
+        for (const auto& [name, value] : Counters()) {
+            text += std::string{name} + ' ' + std::to_string(value) + '\n';
+        }
+        for (size_t i = 0; i < kEvictionAgeBuckets; ++i) {
+            if (eviction_age[i]) {
+                text += "eviction_age_ms ";
+                if (i + 1 < kEvictionAgeBuckets) {
+                    text += '<' + std::to_string(uint64_t{1} << i);
+                } else {
+                    text += ">=" + std::to_string(uint64_t{1} << (i - 1));
+                }
+                text += ' ' + std::to_string(eviction_age[i]) + '\n';
+            }
+        }
+        return text;
+    }
+
+    // Объект со счетчиками и массивом eviction_age_ms из всех корзин по порядку.
+    std::string ToJson() const {
+        std::string json = "{";
+        for (const auto& [name, value] : Counters()) {
+            json += '"' + std::string{name} + "\": " + std::to_string(value) + ", ";
+        }
+        json += "\"eviction_age_ms\": [";
+        for (size_t i = 0; i < kEvictionAgeBuckets; ++i) {
+            json += (i ? ", " : "") + std::to_string(eviction_age[i]);
+        }
+        return json + "]}";
+    }
+
+private:
+    std::array<std::pair<const char*, uint64_t>, 8> Counters() const {
+        return {{{"hits", hits},
+                 {"misses", misses},
+                 {"inserts", inserts},
+                 {"updates", updates},
+                 {"evictions", evictions},
+                 {"expirations", expirations},
+                 {"size", size},
+                 {"weight", weight}}};
+    }
+};
+
+// Счетчик, который увеличивают из нескольких потоков; порядок с другими операциями
+// не важен, поэтому relaxed.
+class RelaxedCounter {
+public:
+    void operator++() {
+        value_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    operator uint64_t() const {
+        return value_.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<uint64_t> value_ = 0;
+};
+
+// Счетчики, которые ведет кеш. Counter - uint64_t у однопоточного кеша и RelaxedCounter
+// у шардов ConcurrentLruCache.
+template <class Counter>
+struct CacheCounters {
+    Counter hits{};
+    Counter misses{};
+    Counter inserts{};
+    Counter updates{};
+    Counter evictions{};
+    Counter expirations{};
+    std::array<Counter, kEvictionAgeBuckets> eviction_age{};
+
+    // Нужно ли запоминать время вставки этой записи.
+    bool SampleInsert() {
+        ++inserts;
+        return inserts % kAgeSampleInterval == 0;
+    }
+
+    void RecordEvictionAge(std::chrono::nanoseconds age) {
+        auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(age).count();
+        size_t bucket = 0;
+        while (bucket + 1 < kEvictionAgeBuckets && milliseconds >= (int64_t{1} << bucket)) {
+            ++bucket;
+        }
+        ++eviction_age[bucket];
+    }
+
+    void AddTo(CacheMetrics* metrics) const {
+        metrics->hits += hits;
+        metrics->misses += misses;
+        metrics->inserts += inserts;
+        metrics->updates += updates;
+        metrics->evictions += evictions;
+        metrics->expirations += expirations;
+        for (size_t i = 0; i < kEvictionAgeBuckets; ++i) {
+            metrics->eviction_age[i] += eviction_age[i];
+        }
+    }
+};
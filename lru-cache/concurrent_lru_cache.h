@@ -0,0 +1,227 @@
+#pragma once
+
+#include <cache_metrics.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+// LRU-кеш для нескольких потоков с тем же интерфейсом, что у LruCache. Ключи по хешу
+// распределяются между независимыми шардами, у каждого своя блокировка и своя доля емкости,
+// поэтому вытесняется самый старый элемент шарда, а не всего кеша.
+//
+// Get берет блокировку шарда только на чтение и не двигает элемент в списке сразу,
+// а записывает его в буфер чтений шарда. Буфер применяется к списку под блокировкой
+// на запись: в начале каждого Set и когда он заполнился. Если полный буфер не удалось
+// сразу применить, следующие чтения теряются, так что порядок давности приблизительный.
+//
+// С metrics = true каждый шард ведет свои счетчики (см. cache_metrics.h), GetMetrics
+// складывает их.
+class ConcurrentLruCache {
+public:
+    static constexpr size_t kDefaultShardCount = 16;
+
+    explicit ConcurrentLruCache(size_t max_size, size_t shard_count = kDefaultShardCount,
+                                bool metrics = false)
+        : shard_count_{std::clamp<size_t>(shard_count, 1, std::max<size_t>(max_size, 1))},
+          shards_{std::make_unique<Shard[]>(shard_count_)},
+          metrics_{metrics} {
+        for (size_t i = 0; i < shard_count_; ++i) {
+            shards_[i].capacity = max_size / shard_count_ + (i < max_size % shard_count_);
+        }
+    }
+
+    ConcurrentLruCache(const ConcurrentLruCache&) = delete;
+    ConcurrentLruCache& operator=(const ConcurrentLruCache&) = delete;
+
+    void Set(const std::string& key, const std::string& value) {
+        auto& shard = GetShard(key);
+        std::unique_lock lock{shard.mutex};
+        DrainReads(&shard);
+        Insert(&shard, key, value);
+    }
+
+    bool Get(const std::string& key, std::string* value) {
+        auto& shard = GetShard(key);
+        bool buffer_full;
+        {
+            std::shared_lock lock{shard.mutex};
+            auto it = shard.index.find(key);
+            if (it == shard.index.end()) {
+                if (metrics_) {
+                    ++shard.counters.misses;
+                }
+                return false;
+            }
+            if (metrics_) {
+                ++shard.counters.hits;
+            }
+            *value = it->second->value;
+            buffer_full = RecordRead(&shard, it->second);
+        }
+
+        if (buffer_full) {
+            std::unique_lock lock{shard.mutex, std::try_to_lock};
+            if (lock) {
+                DrainReads(&shard);
+            }
+        }
+        return true;
+    }
+
+    // Значение по ключу, а при промахе - результат loader(), который заодно кладется в кеш.
+    // Пока loader работает, остальные потоки, запросившие тот же ключ, не вызывают его
+    // повторно, а ждут того же результата. Исключение из loader получают все ждавшие,
+    // и в кеш ничего не попадает: следующий запрос вызовет loader заново.
+    template <class Loader>
+    std::string GetOrCompute(const std::string& key, Loader&& loader) {
+        std::string value;
+        if (Get(key, &value)) {
+            return value;
+        }
+
+        auto& shard = GetShard(key);
+        std::promise<std::string> promise;
+        {
+            std::unique_lock lock{shard.mutex};
+            DrainReads(&shard);
+            if (auto it = shard.index.find(key); it != shard.index.end()) {
+                shard.items.splice(shard.items.begin(), shard.items, it->second);
+                return it->second->value;
+            }
+            if (auto it = shard.loading.find(key); it != shard.loading.end()) {
+                auto result = it->second;
+                lock.unlock();
+                return result.get();
+            }
+            shard.loading.emplace(key, promise.get_future().share());
+        }
+
+        try {
+            value = std::invoke(std::forward<Loader>(loader));
+        } catch (...) {
+            {
+                std::unique_lock lock{shard.mutex};
+                shard.loading.erase(key);
+            }
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+        {
+            std::unique_lock lock{shard.mutex};
+            DrainReads(&shard);
+            Insert(&shard, key, value);
+            shard.loading.erase(key);
+        }
+        promise.set_value(value);
+        return value;
+    }
+
+    CacheMetrics GetMetrics() const {
+        CacheMetrics metrics;
+        for (size_t i = 0; i < shard_count_; ++i) {
+            auto& shard = shards_[i];
+            std::shared_lock lock{shard.mutex};
+            shard.counters.AddTo(&metrics);
+            metrics.size += shard.index.size();
+        }
+        return metrics;
+    }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+    static constexpr size_t kReadBufferSize = 64;
+
+    using Clock = std::chrono::steady_clock;
+
+    struct Item {
+        std::string key;
+        std::string value;
+        // Время вставки, если по этой записи измеряется возраст при вытеснении.
+        Clock::time_point inserted = Clock::time_point::min();
+    };
+
+    using List = std::list<Item>;
+
+    struct alignas(kCacheLineSize) Shard {
+        std::shared_mutex mutex;
+        size_t capacity = 0;
+        // От последнего использованного к самому старому; ключи индекса указывают в узлы.
+        List items;
+        std::unordered_map<std::string_view, List::iterator> index;
+        // Читатели пишут в разные ячейки под блокировкой на чтение, а разбирается буфер
+        // только под блокировкой на запись, так что сами ячейки атомарными быть не должны.
+        std::array<List::iterator, kReadBufferSize> read_buffer;
+        std::atomic<size_t> read_count = 0;
+        // Ключи, для которых сейчас работает loader в GetOrCompute.
+        std::unordered_map<std::string, std::shared_future<std::string>> loading;
+        CacheCounters<RelaxedCounter> counters;
+    };
+
+    Shard& GetShard(std::string_view key) {
+        return shards_[std::hash<std::string_view>{}(key) % shard_count_];
+    }
+
+    // Вызывается под блокировкой на запись после DrainReads.
+    void Insert(Shard* shard, const std::string& key, const std::string& value) {
+        if (auto it = shard->index.find(key); it != shard->index.end()) {
+            if (metrics_) {
+                ++shard->counters.updates;
+            }
+            it->second->value = value;
+            shard->items.splice(shard->items.begin(), shard->items, it->second);
+            return;
+        }
+
+        shard->items.push_front({key, value});
+        if (metrics_ && shard->counters.SampleInsert()) {
+            shard->items.front().inserted = Clock::now();
+        }
+        shard->index.emplace(shard->items.front().key, shard->items.begin());
+        if (shard->index.size() > shard->capacity) {
+            const auto& evicted = shard->items.back();
+            if (metrics_) {
+                ++shard->counters.evictions;
+                if (evicted.inserted != Clock::time_point::min()) {
+                    shard->counters.RecordEvictionAge(Clock::now() - evicted.inserted);
+                }
+            }
+            shard->index.erase(evicted.key);
+            shard->items.pop_back();
+        }
+    }
+
+    // Возвращает true, если буфер заполнен и его пора применить.
+    static bool RecordRead(Shard* shard, List::iterator item) {
+        auto position = shard->read_count.fetch_add(1, std::memory_order_relaxed);
+        if (position < kReadBufferSize) {
+            shard->read_buffer[position] = item;
+        }
+        return position + 1 >= kReadBufferSize;
+    }
+
+    // Вызывается под блокировкой на запись, поэтому все элементы из буфера еще живы:
+    // удалить их можно только под той же блокировкой, а она всегда начинается с разбора.
+    static void DrainReads(Shard* shard) {
+        auto count = std::min(shard->read_count.load(std::memory_order_relaxed), kReadBufferSize);
+        for (size_t i = 0; i < count; ++i) {
+            shard->items.splice(shard->items.begin(), shard->items, shard->read_buffer[i]);
+        }
+        shard->read_count.store(0, std::memory_order_relaxed);
+    }
+
+    size_t shard_count_;
+    std::unique_ptr<Shard[]> shards_;
+    bool metrics_;
+};
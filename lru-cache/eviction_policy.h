@@ -0,0 +1,348 @@
+#pragma once
+
+#include <hash_index.h>
+#include <index_lists.h>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Политика вытеснения для PooledLruCache. Кеш хранит ключи и значения в массиве узлов,
+// а политика знает только номера узлов и хеши ключей и сама решает, кого вытеснить:
+//   OnHit(index)         - обращение к ключу, который есть в кеше;
+//   OnMiss(hash)         - Get ключа, которого нет;
+//   Evict(hash)          - кеш полон, а нужно вставить ключ с таким хешем:
+//                          вернуть номер узла, который освободится под него;
+//   OnInsert(index, hash) - ключ вставлен в узел index;
+//   Remove(index)        - кеш сам удалил ключ из узла, например по истечении времени.
+// Номера узлов меньше capacity, с которым создана политика.
+template <class Policy>
+concept EvictionPolicy = std::constructible_from<Policy, size_t> &&
+                         requires(Policy policy, uint32_t index, size_t hash) {
+                             policy.OnHit(index);
+                             policy.OnMiss(hash);
+                             { policy.Evict(hash) } -> std::same_as<uint32_t>;
+                             policy.OnInsert(index, hash);
+                             policy.Remove(index);
+                         };
+
+class LruPolicy {
+public:
+    explicit LruPolicy(size_t capacity) : lists_{capacity} {
+    }
+
+    void OnHit(uint32_t index) {
+        lists_.MoveToFront(&recent_, index);
+    }
+
+    void OnMiss(size_t) {
+    }
+
+    uint32_t Evict(size_t) {
+        return lists_.PopBack(&recent_);
+    }
+
+    void OnInsert(uint32_t index, size_t) {
+        lists_.PushFront(&recent_, index);
+    }
+
+    void Remove(uint32_t index) {
+        lists_.Remove(&recent_, index);
+    }
+
+private:
+    IndexLists lists_;
+    IndexLists::List recent_;
+};
+
+// Count-min sketch из 4-битных счетчиков: оценка сверху частоты обращений к хешу.
+// Когда число увеличений доходит до 10 * capacity, все счетчики делятся пополам,
+// так что старая популярность со временем забывается.
+class FrequencySketch {
+public:
+    explicit FrequencySketch(size_t capacity)
+        : width_{std::bit_ceil(std::max<size_t>(capacity, 16))},
+          counters_(kRows * width_),
+          sample_size_{10 * std::max<size_t>(capacity, 1)} {
+    }
+
+    void Increment(size_t hash) {
+        auto added = false;
+        for (size_t row = 0; row < kRows; ++row) {
+            if (auto& counter = counters_[Position(hash, row)]; counter < kMaxCount) {
+                ++counter;
+                added = true;
+            }
+        }
+        if (added && ++additions_ == sample_size_) {
+            Reset();
+        }
+    }
+
+    uint8_t Frequency(size_t hash) const {
+        uint8_t frequency = kMaxCount;
+        for (size_t row = 0; row < kRows; ++row) {
+            frequency = std::min(frequency, counters_[Position(hash, row)]);
+        }
+        return frequency;
+    }
+
+private:
+    static constexpr size_t kRows = 4;
+    static constexpr uint8_t kMaxCount = 15;
+    static constexpr std::array<uint64_t, kRows> kSeeds = {
+        0x9e3779b97f4a7c15, 0xbf58476d1ce4e5b9, 0x94d049bb133111eb, 0xd6e8feb86659fd93};
+
+    size_t Position(size_t hash, size_t row) const {
+        auto mixed = (hash ^ kSeeds[row]) * kSeeds[(row + 1) % kRows];
+        return row * width_ + ((mixed ^ (mixed >> 32)) & (width_ - 1));
+    }
+
+    void Reset() {
+        for (auto& counter : counters_) {
+            counter >>= 1;
+        }
+        additions_ /= 2;
+    }
+
+    size_t width_;
+    std::vector<uint8_t> counters_;
+    size_t sample_size_;
+    size_t additions_ = 0;
+};
+
+// W-TinyLFU. Новые ключи попадают в маленькое LRU-окно (1% емкости), основная часть -
+// сегментированный LRU: испытательный список и защищенный (80% основной части), куда
+// переходит ключ при повторном обращении. Ключ, выпавший из окна, попадает в основную
+// часть, только если по sketch к нему обращались чаще, чем к ее кандидату на вытеснение,
+// поэтому однократный последовательный проход не вымывает популярные ключи.
+class TinyLfuPolicy {
+public:
+    explicit TinyLfuPolicy(size_t capacity)
+        : lists_{capacity},
+          hashes_(capacity),
+          places_(capacity),
+          sketch_{capacity},
+          window_capacity_{std::max<size_t>(capacity / 100, 1)},
+          protected_capacity_{(capacity - std::min(capacity, window_capacity_)) * 4 / 5} {
+    }
+
+    void OnHit(uint32_t index) {
+        sketch_.Increment(hashes_[index]);
+        switch (places_[index]) {
+            case Place::kWindow:
+                lists_.MoveToFront(&window_, index);
+                break;
+            case Place::kProbation:
+                lists_.Remove(&probation_, index);
+                PushProtected(index);
+                break;
+            case Place::kProtected:
+                lists_.MoveToFront(&protected_, index);
+                break;
+        }
+    }
+
+    void OnMiss(size_t hash) {
+        sketch_.Increment(hash);
+    }
+
+    // Новый ключ займет место в окне. Если окно заполнено, его самый старый ключ
+    // соревнуется с жертвой основной части, иначе вытесняется сразу жертва. Кеш
+    // вытесняет и по весу, когда он еще не полон, - тогда основная часть может быть
+    // пуста, и вытесняется самый старый ключ окна.
+    uint32_t Evict(size_t) {
+        auto* main = probation_.size ? &probation_ : &protected_;
+        if (window_.size < window_capacity_) {
+            return lists_.PopBack(main->size ? main : &window_);
+        }
+        auto candidate = lists_.PopBack(&window_);
+        if (!main->size) {
+            return candidate;
+        }
+        auto victim = main->tail;
+        if (sketch_.Frequency(hashes_[candidate]) <= sketch_.Frequency(hashes_[victim])) {
+            return candidate;
+        }
+        lists_.Remove(main, victim);
+        PushProbation(candidate);
+        return victim;
+    }
+
+    void OnInsert(uint32_t index, size_t hash) {
+        hashes_[index] = hash;
+        sketch_.Increment(hash);
+        places_[index] = Place::kWindow;
+        lists_.PushFront(&window_, index);
+        if (window_.size > window_capacity_) {
+            PushProbation(lists_.PopBack(&window_));
+        }
+    }
+
+    void Remove(uint32_t index) {
+        lists_.Remove(GetList(places_[index]), index);
+    }
+
+private:
+    enum class Place : uint8_t {
+        kWindow,
+        kProbation,
+        kProtected,
+    };
+
+    IndexLists::List* GetList(Place place) {
+        switch (place) {
+            case Place::kWindow:
+                return &window_;
+            case Place::kProbation:
+                return &probation_;
+            case Place::kProtected:
+                return &protected_;
+        }
+        return nullptr;
+    }
+
+    void PushProbation(uint32_t index) {
+        places_[index] = Place::kProbation;
+        lists_.PushFront(&probation_, index);
+    }
+
+    void PushProtected(uint32_t index) {
+        places_[index] = Place::kProtected;
+        lists_.PushFront(&protected_, index);
+        if (protected_.size > protected_capacity_) {
+            PushProbation(lists_.PopBack(&protected_));
+        }
+    }
+
+    IndexLists lists_;
+    IndexLists::List window_;
+    IndexLists::List probation_;
+    IndexLists::List protected_;
+    std::vector<size_t> hashes_;
+    std::vector<Place> places_;
+    FrequencySketch sketch_;
+    size_t window_capacity_;
+    size_t protected_capacity_;
+};
+
+// Adaptive Replacement Cache. Ключи в кеше делятся на встреченные один раз (recent)
+// и повторно (frequent); для вытесненных из каждого списка помнятся хеши (призраки).
+// Промах по призраку recent значит, что recent стоило держать больше, и наоборот:
+// целевой размер recent сдвигается в сторону списка, чьих призраков спрашивают.
+class ArcPolicy {
+public:
+    explicit ArcPolicy(size_t capacity)
+        : capacity_{capacity},
+          lists_{capacity},
+          hashes_(capacity),
+          frequent_flags_(capacity),
+          ghost_lists_{capacity + 1},
+          ghost_hashes_(capacity + 1),
+          ghost_frequent_(capacity + 1),
+          ghost_index_{capacity + 1} {
+        for (uint32_t i = 0; i <= capacity; ++i) {
+            ghost_lists_.PushFront(&free_ghosts_, i);
+        }
+    }
+
+    void OnHit(uint32_t index) {
+        Remove(index);
+        frequent_flags_[index] = true;
+        lists_.PushFront(&frequent_, index);
+    }
+
+    void OnMiss(size_t) {
+    }
+
+    uint32_t Evict(size_t hash) {
+        auto ghost = FindGhost(hash);
+        auto frequent_ghost = ghost != IndexLists::kNone && ghost_frequent_[ghost];
+        if (ghost != IndexLists::kNone && !frequent_ghost) {
+            auto delta = std::max<size_t>(frequent_ghosts_.size / recent_ghosts_.size, 1);
+            target_ = std::min(capacity_, target_ + delta);
+        } else if (frequent_ghost) {
+            auto delta = std::max<size_t>(recent_ghosts_.size / frequent_ghosts_.size, 1);
+            target_ -= std::min(target_, delta);
+        }
+
+        auto from_recent = recent_.size && (recent_.size > target_ ||
+                                            (frequent_ghost && recent_.size == target_));
+        if (!frequent_.size) {
+            from_recent = true;
+        }
+        auto victim = lists_.PopBack(from_recent ? &recent_ : &frequent_);
+        AddGhost(hashes_[victim], !from_recent);
+        return victim;
+    }
+
+    void OnInsert(uint32_t index, size_t hash) {
+        hashes_[index] = hash;
+        auto ghost = FindGhost(hash);
+        frequent_flags_[index] = ghost != IndexLists::kNone;
+        if (ghost != IndexLists::kNone) {
+            RemoveGhost(ghost);
+        }
+        lists_.PushFront(frequent_flags_[index] ? &frequent_ : &recent_, index);
+
+        // Призраков recent не больше, чем мест, которых recent не занимает,
+        // а всего ключей и призраков - не больше удвоенной емкости.
+        while (recent_ghosts_.size && recent_.size + recent_ghosts_.size > capacity_) {
+            RemoveGhost(recent_ghosts_.tail);
+        }
+        auto size = recent_.size + frequent_.size;
+        while (frequent_ghosts_.size &&
+               size + recent_ghosts_.size + frequent_ghosts_.size > 2 * capacity_) {
+            RemoveGhost(frequent_ghosts_.tail);
+        }
+    }
+
+    void Remove(uint32_t index) {
+        lists_.Remove(frequent_flags_[index] ? &frequent_ : &recent_, index);
+    }
+
+private:
+    uint32_t FindGhost(size_t hash) const {
+        return ghost_index_.Find(hash, [](uint32_t) { return true; });
+    }
+
+    void AddGhost(size_t hash, bool frequent) {
+        if (!free_ghosts_.size) {
+            RemoveGhost(frequent_ghosts_.size ? frequent_ghosts_.tail : recent_ghosts_.tail);
+        }
+        auto ghost = ghost_lists_.PopBack(&free_ghosts_);
+        ghost_hashes_[ghost] = hash;
+        ghost_frequent_[ghost] = frequent;
+        ghost_lists_.PushFront(frequent ? &frequent_ghosts_ : &recent_ghosts_, ghost);
+        ghost_index_.Insert(hash, ghost);
+    }
+
+    void RemoveGhost(uint32_t ghost) {
+        ghost_index_.Erase(ghost_hashes_[ghost], ghost);
+        ghost_lists_.Remove(ghost_frequent_[ghost] ? &frequent_ghosts_ : &recent_ghosts_, ghost);
+        ghost_lists_.PushFront(&free_ghosts_, ghost);
+    }
+
+    size_t capacity_;
+    // Целевой размер recent.
+    size_t target_ = 0;
+
+    IndexLists lists_;
+    IndexLists::List recent_;
+    IndexLists::List frequent_;
+    std::vector<size_t> hashes_;
+    std::vector<bool> frequent_flags_;
+
+    // Призраки - отдельные записи с хешами, их не больше capacity + 1.
+    IndexLists ghost_lists_;
+    IndexLists::List recent_ghosts_;
+    IndexLists::List frequent_ghosts_;
+    IndexLists::List free_ghosts_;
+    std::vector<size_t> ghost_hashes_;
+    std::vector<bool> ghost_frequent_;
+    HashIndex ghost_index_;
+};
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <chrono>
+
+// Часы для тестов времени жизни записей: время двигают вручную через current.
+struct FakeClock {
+    using duration = std::chrono::nanoseconds;
+    using rep = duration::rep;
+    using period = duration::period;
+    using time_point = std::chrono::time_point<FakeClock>;
+    static constexpr bool is_steady = true;
+
+    static time_point now() {
+        return current;
+    }
+
+    static inline time_point current{};
+};
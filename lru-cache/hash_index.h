@@ -0,0 +1,71 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Хеш-индекс над внешним массивом элементов: открытая адресация с линейным пробированием,
+// в ячейке лежат хеш и номер элемента. Сами ключи индекс не хранит, их сравнивает
+// предикат, который передается в Find. Не выделяет память после создания: число ячеек
+// заранее выбрано так, чтобы capacity элементов занимали не больше половины.
+class HashIndex {
+public:
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    explicit HashIndex(size_t capacity) : slots_(std::bit_ceil(2 * capacity + 1)) {
+    }
+
+    // Первый элемент с таким хешем, для которого matches(index) истинно, или kNone.
+    template <class Predicate>
+    uint32_t Find(size_t hash, Predicate matches) const {
+        for (auto slot = hash & Mask(); slots_[slot].index != kNone; slot = Next(slot)) {
+            if (slots_[slot].hash == hash && matches(slots_[slot].index)) {
+                return slots_[slot].index;
+            }
+        }
+        return kNone;
+    }
+
+    void Insert(size_t hash, uint32_t index) {
+        auto slot = hash & Mask();
+        while (slots_[slot].index != kNone) {
+            slot = Next(slot);
+        }
+        slots_[slot] = {hash, index};
+    }
+
+    // Удаление без надгробий: следующие элементы цепочки сдвигаются на освободившееся
+    // место, если оно не раньше их домашней ячейки.
+    void Erase(size_t hash, uint32_t index) {
+        auto slot = hash & Mask();
+        while (slots_[slot].index != index) {
+            slot = Next(slot);
+        }
+        for (auto next = Next(slot); slots_[next].index != kNone; next = Next(next)) {
+            auto home = slots_[next].hash & Mask();
+            if (((next - home) & Mask()) >= ((next - slot) & Mask())) {
+                slots_[slot] = slots_[next];
+                slot = next;
+            }
+        }
+        slots_[slot].index = kNone;
+    }
+
+private:
+    struct Slot {
+        size_t hash = 0;
+        uint32_t index = kNone;
+    };
+
+    size_t Mask() const {
+        return slots_.size() - 1;
+    }
+
+    size_t Next(size_t slot) const {
+        return (slot + 1) & Mask();
+    }
+
+    std::vector<Slot> slots_;
+};
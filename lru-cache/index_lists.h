@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Двусвязные списки над номерами элементов 0..size-1 внешнего массива. Связи хранятся
+// здесь, общие для всех списков, поэтому каждый номер одновременно лежит не больше
+// чем в одном из них.
+class IndexLists {
+public:
+    static constexpr uint32_t kNone = std::numeric_limits<uint32_t>::max();
+
+    // От последнего добавленного к самому старому.
+    struct List {
+        uint32_t head = kNone;
+        uint32_t tail = kNone;
+        size_t size = 0;
+    };
+
+    explicit IndexLists(size_t size) : links_(size) {
+    }
+
+    void PushFront(List* list, uint32_t index) {
+        links_[index] = {kNone, list->head};
+        (list->head == kNone ? list->tail : links_[list->head].prev) = index;
+        list->head = index;
+        ++list->size;
+    }
+
+    void Remove(List* list, uint32_t index) {
+        const auto& link = links_[index];
+        (link.prev == kNone ? list->head : links_[link.prev].next) = link.next;
+        (link.next == kNone ? list->tail : links_[link.next].prev) = link.prev;
+        --list->size;
+    }
+
+    void MoveToFront(List* list, uint32_t index) {
+        if (list->head != index) {
+            Remove(list, index);
+            PushFront(list, index);
+        }
+    }
+
+    uint32_t PopBack(List* list) {
+        auto index = list->tail;
+        Remove(list, index);
+        return index;
+    }
+
+private:
+    struct Link {
+        uint32_t prev;
+        uint32_t next;
+    };
+
+    std::vector<Link> links_;
+};
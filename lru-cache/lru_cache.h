@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cache_metrics.h>
+
+#include <chrono>
 #include <list>
 #include <string>
 #include <unordered_map>
@@ -9,11 +12,15 @@ struct ListNode {
     ListNode* prev;
     std::string key;
     std::string value;
+    // Время вставки, если по этой записи измеряется возраст при вытеснении.
+    std::chrono::steady_clock::time_point inserted = std::chrono::steady_clock::time_point::min();
 };
 
+// С metrics = true кеш ведет счетчики обращений и вытеснений, см. GetMetrics.
 class LruCache {
 public:
-    explicit LruCache(size_t max_size) : size_(), capacity_(max_size), head_(nullptr), cache_() {
+    explicit LruCache(size_t max_size, bool metrics = false)
+        : size_(), capacity_(max_size), head_(nullptr), cache_(), metrics_(metrics) {
     }
 
     LruCache(const LruCache&) = delete;
@@ -21,8 +28,15 @@ public:
 
     void Set(const std::string& key, const std::string& value) {
         ListNode* node;
-        if (cache_.contains(key)) {
+        auto inserted = std::chrono::steady_clock::time_point::min();
+        bool updated = cache_.contains(key);
+        if (updated) {
             node = cache_[key];
+            if (metrics_) {
+                ++counters_.updates;
+            }
+            // Возраст записи считается от первой вставки ключа.
+            inserted = node->inserted;
             if (node != head_) {
                 node->prev->next = node->next;
                 if (node == head_->prev) {
@@ -42,7 +56,10 @@ public:
             delete node;
         }
 
-        node = new ListNode{head_, nullptr, key, value};
+        node = new ListNode{head_, nullptr, key, value, inserted};
+        if (metrics_ && !updated && counters_.SampleInsert()) {
+            node->inserted = std::chrono::steady_clock::now();
+        }
         if (head_) {
             node->prev = head_->prev;
             head_->prev = node;
@@ -56,6 +73,13 @@ public:
 
         if (size_ > capacity_) {
             node = head_->prev;
+            if (metrics_) {
+                ++counters_.evictions;
+                if (node->inserted != std::chrono::steady_clock::time_point::min()) {
+                    counters_.RecordEvictionAge(std::chrono::steady_clock::now() -
+                                                node->inserted);
+                }
+            }
             node->prev->next = node->next;
             head_->prev = node->prev;
             cache_.erase(node->key);
@@ -82,13 +106,27 @@ public:
                 node->next = head_;
                 head_ = node;
             }
+            if (metrics_) {
+                ++counters_.hits;
+            }
             *value = node->value;
             return true;
         } else {
+            if (metrics_) {
+                ++counters_.misses;
+            }
             return false;
         }
     }
 
+    // Без metrics счетчики нулевые, заполнен только размер.
+    CacheMetrics GetMetrics() const {
+        CacheMetrics metrics;
+        counters_.AddTo(&metrics);
+        metrics.size = size_;
+        return metrics;
+    }
+
     ~LruCache() {
         ListNode* node = head_;
         while (node) {
@@ -106,4 +144,6 @@ private:
     size_t size_, capacity_;
     ListNode* head_;
     std::unordered_map<std::string, ListNode*> cache_;
+    bool metrics_;
+    CacheCounters<uint64_t> counters_;
 };
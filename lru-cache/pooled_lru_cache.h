@@ -0,0 +1,309 @@
+#pragma once
+
+#include <cache_metrics.h>
+#include <eviction_policy.h>
+#include <hash_index.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Хеш строк, которым можно искать и по std::string_view, не создавая ключ.
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view key) const {
+        return std::hash<std::string_view>{}(key);
+    }
+};
+
+template <class Key>
+using DefaultLruHash = std::conditional_t<std::is_same_v<Key, std::string>, StringHash,
+                                          std::hash<Key>>;
+
+// Вес записи по умолчанию - сколько байт занимают ключ и значение, у строк вместе
+// с содержимым.
+struct SizeWeigher {
+    template <class Key, class Value>
+    size_t operator()(const Key& key, const Value& value) const {
+        return ByteSize(key) + ByteSize(value);
+    }
+
+private:
+    template <class T>
+    static size_t ByteSize(const T& object) {
+        if constexpr (std::is_same_v<T, std::string>) {
+            return sizeof(T) + object.size();
+        } else {
+            return sizeof(T);
+        }
+    }
+};
+
+struct CacheOptions {
+    // Предел суммарного веса записей: после каждого Set вытесняется, пока вес больше.
+    size_t max_weight = std::numeric_limits<size_t>::max();
+    // Время жизни записи по умолчанию, ноль - бессрочно.
+    std::chrono::nanoseconds ttl{};
+    // Вести счетчики обращений и вытеснений, см. GetMetrics.
+    bool metrics = false;
+};
+
+// Настройки одной записи в Set; если не указаны, вес считает Weigher, а время жизни
+// берется из CacheOptions.
+struct EntryOptions {
+    std::optional<size_t> weight = std::nullopt;
+    std::optional<std::chrono::nanoseconds> ttl = std::nullopt;
+};
+
+// Кеш, который после заполнения не выделяет память. Узлы лежат в заранее
+// зарезервированном массиве на capacity элементов; освободившийся узел переиспользуется
+// под новый ключ присваиванием, так что строки сохраняют свои буферы. Вместо
+// std::unordered_map - HashIndex по номерам узлов. Кого вытеснять, решает Policy
+// (см. eviction_policy.h), по умолчанию - LRU.
+//
+// Кроме числа записей можно ограничить их суммарный вес (CacheOptions::max_weight).
+// Тогда у освобожденных узлов значение уничтожается, чтобы большие значения не держали
+// память после вытеснения.
+//
+// Записи с временем жизни истекают лениво: Get не вернет истекшую запись и сразу удалит ее.
+// Кроме того, каждый Set проверяет несколько следующих узлов массива по кругу, так что
+// истекшие записи, к которым больше не обращаются, тоже освобождаются без отдельного потока.
+//
+// Искать можно любым типом, который умеют хешировать Hash и сравнивать KeyEqual,
+// например std::string_view для строковых ключей. Get без второго аргумента возвращает
+// указатель на значение внутри кеша, он действителен до следующего Set.
+template <class Key, class Value, EvictionPolicy Policy = LruPolicy,
+          class Hash = DefaultLruHash<Key>, class KeyEqual = std::equal_to<>,
+          class Weigher = SizeWeigher, class Clock = std::chrono::steady_clock>
+class PooledLruCache {
+public:
+    explicit PooledLruCache(size_t capacity, CacheOptions options = {})
+        : capacity_{capacity},
+          max_weight_{options.max_weight},
+          ttl_{options.ttl},
+          metrics_{options.metrics},
+          index_{capacity},
+          policy_{capacity} {
+        nodes_.reserve(capacity);
+        free_.reserve(capacity);
+    }
+
+    PooledLruCache(const PooledLruCache&) = delete;
+    PooledLruCache& operator=(const PooledLruCache&) = delete;
+
+    template <class K, class V>
+    void Set(K&& key, V&& value, EntryOptions options = {}) {
+        SweepExpired(kSweepStep);
+
+        auto hash = Hash{}(key);
+        auto index = FindNode(key, hash);
+        if (index != kNone) {
+            if (metrics_) {
+                ++counters_.updates;
+            }
+            nodes_[index].value = std::forward<V>(value);
+            policy_.OnHit(index);
+        } else {
+            if (!capacity_) {
+                return;
+            }
+            if (Size() == capacity_) {
+                RemoveEvicted(policy_.Evict(hash));
+            }
+            if (!free_.empty()) {
+                index = free_.back();
+                free_.pop_back();
+                auto& node = nodes_[index];
+                node.key = std::forward<K>(key);
+                node.value = std::forward<V>(value);
+            } else {
+                index = nodes_.size();
+                nodes_.push_back({Key(std::forward<K>(key)), Value(std::forward<V>(value))});
+            }
+            auto& node = nodes_[index];
+            node.hash = hash;
+            node.used = true;
+            node.sampled = metrics_ && counters_.SampleInsert();
+            if (node.sampled) {
+                node.inserted = Clock::now();
+            }
+            index_.Insert(hash, index);
+            policy_.OnInsert(index, hash);
+        }
+
+        auto& node = nodes_[index];
+        weight_ -= node.weight;
+        node.weight = options.weight ? *options.weight : Weigher{}(node.key, node.value);
+        weight_ += node.weight;
+        SetExpiry(&node, options.ttl.value_or(ttl_));
+
+        while (weight_ > max_weight_) {
+            RemoveEvicted(policy_.Evict(hash));
+        }
+    }
+
+    template <class K>
+    const Value* Get(const K& key) {
+        auto hash = Hash{}(key);
+        auto index = FindNode(key, hash);
+        if (index != kNone && nodes_[index].expires != kNever &&
+            nodes_[index].expires <= Clock::now()) {
+            RemoveExpired(index);
+            index = kNone;
+        }
+        if (index == kNone) {
+            if (metrics_) {
+                ++counters_.misses;
+            }
+            policy_.OnMiss(hash);
+            return nullptr;
+        }
+        if (metrics_) {
+            ++counters_.hits;
+        }
+        policy_.OnHit(index);
+        return &nodes_[index].value;
+    }
+
+    template <class K>
+    bool Get(const K& key, Value* value) {
+        if (const auto* found = Get(key)) {
+            *value = *found;
+            return true;
+        }
+        return false;
+    }
+
+    // Удаляет все истекшие записи сразу.
+    void RemoveExpired() {
+        SweepExpired(nodes_.size());
+    }
+
+    size_t Size() const {
+        return nodes_.size() - free_.size();
+    }
+
+    size_t Capacity() const {
+        return capacity_;
+    }
+
+    size_t Weight() const {
+        return weight_;
+    }
+
+    // Без CacheOptions::metrics счетчики нулевые, заполнены только размер и вес.
+    CacheMetrics GetMetrics() const {
+        CacheMetrics metrics;
+        counters_.AddTo(&metrics);
+        metrics.size = Size();
+        metrics.weight = weight_;
+        return metrics;
+    }
+
+private:
+    static constexpr uint32_t kNone = HashIndex::kNone;
+    static constexpr size_t kSweepStep = 2;
+    static constexpr auto kNever = Clock::time_point::max();
+
+    struct Node {
+        Key key;
+        Value value;
+        size_t hash = 0;
+        size_t weight = 0;
+        typename Clock::time_point expires = kNever;
+        // Время вставки, если по этой записи измеряется возраст при вытеснении.
+        typename Clock::time_point inserted{};
+        bool used = false;
+        bool sampled = false;
+    };
+
+    template <class K>
+    uint32_t FindNode(const K& key, size_t hash) const {
+        return index_.Find(hash, [this, &key](uint32_t index) {
+            return KeyEqual{}(nodes_[index].key, key);
+        });
+    }
+
+    void SetExpiry(Node* node, std::chrono::nanoseconds ttl) {
+        expiring_ -= node->expires != kNever;
+        node->expires = kNever;
+        if (ttl.count() > 0) {
+            node->expires =
+                Clock::now() + std::chrono::duration_cast<typename Clock::duration>(ttl);
+            ++expiring_;
+        }
+    }
+
+    // Узел уже убран из политики.
+    void RemoveEvicted(uint32_t index) {
+        if (metrics_) {
+            ++counters_.evictions;
+            if (nodes_[index].sampled) {
+                counters_.RecordEvictionAge(Clock::now() - nodes_[index].inserted);
+            }
+        }
+        Remove(index);
+    }
+
+    void RemoveExpired(uint32_t index) {
+        if (metrics_) {
+            ++counters_.expirations;
+        }
+        policy_.Remove(index);
+        Remove(index);
+    }
+
+    void Remove(uint32_t index) {
+        auto& node = nodes_[index];
+        index_.Erase(node.hash, index);
+        weight_ -= node.weight;
+        node.weight = 0;
+        expiring_ -= node.expires != kNever;
+        node.expires = kNever;
+        node.used = false;
+        if (max_weight_ != std::numeric_limits<size_t>::max()) {
+            [[maybe_unused]] auto released = std::move(node.value);
+        }
+        free_.push_back(index);
+    }
+
+    // Проверяет count следующих узлов, начиная с того, на котором остановилась прошлая
+    // проверка.
+    void SweepExpired(size_t count) {
+        if (!expiring_) {
+            return;
+        }
+        auto now = Clock::now();
+        for (size_t i = 0; i < count && i < nodes_.size(); ++i) {
+            sweep_position_ = sweep_position_ + 1 < nodes_.size() ? sweep_position_ + 1 : 0;
+            const auto& node = nodes_[sweep_position_];
+            if (node.used && node.expires <= now) {
+                RemoveExpired(sweep_position_);
+            }
+        }
+    }
+
+    size_t capacity_;
+    size_t max_weight_;
+    std::chrono::nanoseconds ttl_;
+    bool metrics_;
+    CacheCounters<uint64_t> counters_;
+    std::vector<Node> nodes_;
+    // Созданные узлы, в которых сейчас нет записи.
+    std::vector<uint32_t> free_;
+    HashIndex index_;
+    Policy policy_;
+    size_t weight_ = 0;
+    // Сколько записей со временем жизни.
+    size_t expiring_ = 0;
+    size_t sweep_position_ = 0;
+};
@@ -0,0 +1,111 @@
+#include <pooled_lru_cache.h>
+
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Доля попаданий разных политик вытеснения на одной трассе обращений.
+// lru-cache-replay [TRACE] [CAPACITY...]: трасса - файл с ключом на каждой строке, каждое
+// обращение - Get, а при промахе Set. Без файла трасса синтетическая: обращения по закону
+// Ципфа к 100000 ключей, после каждых 50000 из которых идет проход по 20000 новых ключей.
+
+namespace {
+
+std::vector<std::string> MakeSyntheticTrace() {
+    constexpr auto kKeys = 100'000;
+    constexpr auto kRounds = 20;
+    constexpr auto kRequests = 50'000;
+    constexpr auto kScan = 20'000;
+
+    std::vector<double> weights(kKeys);
+    for (auto i = 0; i < kKeys; ++i) {
+        weights[i] = 1 / std::pow(i + 1, 0.9);
+    }
+    std::discrete_distribution<int> zipf{weights.begin(), weights.end()};
+    std::mt19937 gen{738'547'485u};
+
+    std::vector<std::string> trace;
+    auto scanned = 0;
+    for (auto round = 0; round < kRounds; ++round) {
+        for (auto i = 0; i < kRequests; ++i) {
+            trace.push_back("user-" + std::to_string(zipf(gen)));
+        }
+        for (auto i = 0; i < kScan; ++i) {
+            trace.push_back("scan-" + std::to_string(scanned++));
+        }
+    }
+    return trace;
+}
+
+std::vector<std::string> ReadTrace(const char* path) {
+    std::ifstream in{path};
+    if (!in) {
+        throw std::runtime_error{std::string{"Cannot open "} + path};
+    }
+    std::vector<std::string> trace;
+    for (std::string key; std::getline(in, key);) {
+        trace.push_back(std::move(key));
+    }
+    return trace;
+}
+
+template <EvictionPolicy Policy>
+double HitRate(const std::vector<std::string>& trace, size_t capacity) {
+    PooledLruCache<std::string, bool, Policy> cache{capacity};
+    size_t hits = 0;
+    for (const auto& key : trace) {
+        if (cache.Get(key)) {
+            ++hits;
+        } else {
+            cache.Set(key, true);
+        }
+    }
+    return 100.0 * hits / trace.size();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const char* path = nullptr;
+    std::vector<size_t> capacities;
+    for (auto i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        size_t capacity;
+        auto [end, error] = std::from_chars(arg.data(), arg.data() + arg.size(), capacity);
+        if (error == std::errc{} && end == arg.data() + arg.size()) {
+            capacities.push_back(capacity);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (capacities.empty()) {
+        capacities = {1'000, 10'000, 50'000};
+    }
+
+    std::vector<std::string> trace;
+    try {
+        trace = path ? ReadTrace(path) : MakeSyntheticTrace();
+    } catch (const std::runtime_error& ex) {
+        std::cerr << ex.what() << '\n';
+        return 1;
+    }
+    if (trace.empty()) {
+        std::cerr << "Empty trace\n";
+        return 1;
+    }
+
+    std::printf("%zu accesses\n", trace.size());
+    std::printf("%-10s %10s %10s %10s\n", "capacity", "lru", "w-tinylfu", "arc");
+    for (auto capacity : capacities) {
+        std::printf("%-10zu %9.2f%% %9.2f%% %9.2f%%\n", capacity,
+                    HitRate<LruPolicy>(trace, capacity), HitRate<TinyLfuPolicy>(trace, capacity),
+                    HitRate<ArcPolicy>(trace, capacity));
+    }
+}
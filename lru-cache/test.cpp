@@ -144,3 +144,25 @@ TEST_CASE("Stress 3") {
         }
     }
 }
+
+TEST_CASE("Metrics") {
+    LruCache cache(2, true);
+    std::string value;
+
+    cache.Set("a", "1");
+    cache.Set("b", "2");
+    cache.Set("a", "3");
+    REQUIRE(cache.Get("a", &value));
+    REQUIRE_FALSE(cache.Get("c", &value));
+    cache.Set("c", "4");
+    REQUIRE_FALSE(cache.Get("b", &value));
+
+    auto metrics = cache.GetMetrics();
+    REQUIRE(metrics.hits == 1);
+    REQUIRE(metrics.misses == 2);
+    REQUIRE(metrics.inserts == 3);
+    REQUIRE(metrics.updates == 1);
+    REQUIRE(metrics.evictions == 1);
+    REQUIRE(metrics.size == 2);
+    REQUIRE(metrics.ToText().starts_with("hits 1\nmisses 2\ninserts 3\nupdates 1\n"));
+}
@@ -0,0 +1,193 @@
+#include <concurrent_lru_cache.h>
+#include <util.h>
+
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("Concurrent set and get") {
+    ConcurrentLruCache cache(10);
+    std::string value;
+
+    cache.Set("a", "1");
+    cache.Set("b", "2");
+    REQUIRE(cache.Get("a", &value));
+    REQUIRE(value == "1");
+    REQUIRE(cache.Get("b", &value));
+    REQUIRE(value == "2");
+    REQUIRE_FALSE(cache.Get("c", &value));
+
+    cache.Set("a", "3");
+    REQUIRE(cache.Get("a", &value));
+    REQUIRE(value == "3");
+}
+
+TEST_CASE("Concurrent eviction in one shard") {
+    ConcurrentLruCache cache(2, 1);
+    std::string value;
+
+    cache.Set("a", "1");
+    cache.Set("b", "2");
+    REQUIRE(cache.Get("a", &value));
+    cache.Set("c", "3");
+    REQUIRE_FALSE(cache.Get("b", &value));
+    REQUIRE(cache.Get("a", &value));
+    REQUIRE(cache.Get("c", &value));
+
+    // Чтений больше, чем вмещает буфер: порядок давности все равно применяется.
+    for (auto i = 0; i < 1'000; ++i) {
+        REQUIRE(cache.Get("a", &value));
+    }
+    cache.Set("d", "4");
+    REQUIRE_FALSE(cache.Get("c", &value));
+    REQUIRE(cache.Get("a", &value));
+    REQUIRE(value == "1");
+}
+
+TEST_CASE("Concurrent capacity") {
+    constexpr auto kSize = 1'000;
+    ConcurrentLruCache cache(kSize);
+    for (auto i = 0; i < 10 * kSize; ++i) {
+        cache.Set(std::to_string(i), "foo");
+    }
+
+    std::string value;
+    auto found = 0;
+    for (auto i = 0; i < 10 * kSize; ++i) {
+        found += cache.Get(std::to_string(i), &value);
+    }
+    REQUIRE(found == kSize);
+}
+
+TEST_CASE("Concurrent stress") {
+    constexpr auto kThreads = 8;
+    constexpr auto kKeys = 500;
+    ConcurrentLruCache cache(100, 4);
+
+    std::vector<std::thread> threads;
+    std::vector<int> errors(kThreads);
+    for (auto i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&cache, &errors, i] {
+            RandomGenerator rnd(i);
+            std::string value;
+            for (auto j = 0; j < 50'000; ++j) {
+                auto key = std::to_string(rnd.GenInt<uint32_t>() % kKeys);
+                if (rnd.GenInt<uint32_t>() % 4 == 0) {
+                    cache.Set(key, key);
+                } else if (cache.Get(key, &value) && value != key) {
+                    ++errors[i];
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto count : errors) {
+        REQUIRE(count == 0);
+    }
+}
+
+TEST_CASE("GetOrCompute runs the loader once") {
+    constexpr auto kThreads = 8;
+    ConcurrentLruCache cache(10);
+    std::atomic<int> calls = 0;
+
+    std::vector<std::thread> threads;
+    std::vector<std::string> results(kThreads);
+    for (auto i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&cache, &calls, &results, i] {
+            results[i] = cache.GetOrCompute("key", [&calls] {
+                ++calls;
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                return std::string{"value"};
+            });
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(calls == 1);
+    for (const auto& result : results) {
+        REQUIRE(result == "value");
+    }
+    std::string value;
+    REQUIRE(cache.Get("key", &value));
+    REQUIRE(value == "value");
+    REQUIRE(cache.GetOrCompute("key", [] { return std::string{"other"}; }) == "value");
+}
+
+TEST_CASE("GetOrCompute propagates exceptions") {
+    constexpr auto kThreads = 8;
+    ConcurrentLruCache cache(10);
+    std::atomic<int> calls = 0;
+    std::atomic<int> errors = 0;
+
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&cache, &calls, &errors] {
+            try {
+                cache.GetOrCompute("key", [&calls]() -> std::string {
+                    ++calls;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    throw std::runtime_error{"backend is down"};
+                });
+            } catch (const std::runtime_error& ex) {
+                errors += std::string_view{ex.what()} == "backend is down";
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    REQUIRE(errors == kThreads);
+    REQUIRE(calls >= 1);
+    std::string value;
+    REQUIRE_FALSE(cache.Get("key", &value));
+    REQUIRE(cache.GetOrCompute("key", [] { return std::string{"value"}; }) == "value");
+}
+
+TEST_CASE("Concurrent metrics") {
+    constexpr auto kThreads = 4;
+    constexpr auto kOperations = 10'000;
+    ConcurrentLruCache cache(100, 4, true);
+
+    std::vector<std::thread> threads;
+    std::vector<int> sets(kThreads);
+    for (auto i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&cache, &sets, i] {
+            RandomGenerator rnd(i);
+            std::string value;
+            for (auto j = 0; j < kOperations; ++j) {
+                auto key = std::to_string(rnd.GenInt(0, 300));
+                if (rnd.GenInt(0, 3) == 0) {
+                    cache.Set(key, key);
+                    ++sets[i];
+                } else {
+                    cache.Get(key, &value);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto metrics = cache.GetMetrics();
+    auto total_sets = 0;
+    for (auto count : sets) {
+        total_sets += count;
+    }
+    REQUIRE(metrics.hits + metrics.misses + total_sets == kThreads * kOperations);
+    REQUIRE(metrics.inserts + metrics.updates == static_cast<uint64_t>(total_sets));
+    REQUIRE(metrics.inserts - metrics.evictions == metrics.size);
+    REQUIRE(metrics.size == 100);
+}
@@ -0,0 +1,151 @@
+#include <pooled_lru_cache.h>
+#include <eviction_policy.h>
+#include <fake_clock.h>
+#include <util.h>
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Сначала kHot ключей читаются много раз, затем один проход по kScan новым ключам.
+template <class Policy>
+int HotKeysAfterScan() {
+    constexpr auto kCapacity = 1'000;
+    constexpr auto kHot = 500;
+    constexpr auto kScan = 10'000;
+
+    PooledLruCache<int, int, Policy> cache{kCapacity};
+    for (auto round = 0; round < 10; ++round) {
+        for (auto key = 0; key < kHot; ++key) {
+            if (!cache.Get(key)) {
+                cache.Set(key, key);
+            }
+        }
+    }
+    for (auto key = kHot; key < kHot + kScan; ++key) {
+        if (!cache.Get(key)) {
+            cache.Set(key, key);
+        }
+    }
+
+    auto found = 0;
+    for (auto key = 0; key < kHot; ++key) {
+        found += cache.Get(key) != nullptr;
+    }
+    return found;
+}
+
+// Каждое попадание возвращает последнее записанное значение, и кеш заполнен целиком.
+template <class Policy>
+void CheckConsistency() {
+    constexpr auto kCapacity = 100;
+    PooledLruCache<int, int, Policy> cache{kCapacity};
+    std::unordered_map<int, int> last;
+    RandomGenerator rnd{431'234};
+    for (auto i = 0; i < 100'000; ++i) {
+        auto key = rnd.GenInt(0, 300);
+        if (rnd.GenInt(0, 1)) {
+            cache.Set(key, i);
+            last[key] = i;
+            REQUIRE(cache.Get(key));
+        } else if (const auto* value = cache.Get(key)) {
+            REQUIRE(*value == last[key]);
+        }
+        REQUIRE(cache.Size() <= kCapacity);
+    }
+
+    auto found = 0;
+    for (auto key = 0; key <= 300; ++key) {
+        found += cache.Get(key) != nullptr;
+    }
+    REQUIRE(found == kCapacity);
+}
+
+// Предел веса и время жизни со случайными весами и сроками: вес не превышает предела,
+// попадания возвращают последнее значение, истекшие записи не возвращаются.
+template <class Policy>
+void CheckWeightAndExpiry() {
+    using namespace std::chrono_literals;
+    using Cache = PooledLruCache<int, int, Policy, std::hash<int>, std::equal_to<>, SizeWeigher,
+                                 FakeClock>;
+    constexpr auto kMaxWeight = 2'000;
+
+    // Вытеснение по весу, пока кеш далеко не полон.
+    {
+        PooledLruCache<std::string, std::string, Policy> cache(1'000, {.max_weight = 1'000});
+        cache.Set("a", "x");
+        cache.Set("b", std::string(5'000, 'x'));
+        REQUIRE(cache.Size() == 0);
+        cache.Set("c", "x");
+        cache.Set("d", std::string(500, 'x'));
+        REQUIRE(cache.Weight() <= 1'000);
+        REQUIRE(cache.Get("d"));
+    }
+
+    Cache cache(100, {.max_weight = kMaxWeight, .ttl = 10s});
+    std::unordered_map<int, std::pair<int, FakeClock::time_point>> last;
+    RandomGenerator rnd{87'654};
+    for (auto i = 0; i < 100'000; ++i) {
+        auto key = rnd.GenInt(0, 300);
+        if (rnd.GenInt(0, 1)) {
+            auto ttl = rnd.GenInt(0, 3) ? 10s : 1s;
+            cache.Set(key, i, {.weight = rnd.GenInt<size_t>(1, 200), .ttl = ttl});
+            last[key] = {i, FakeClock::now() + ttl};
+            REQUIRE(cache.Weight() <= kMaxWeight);
+        } else if (const auto* value = cache.Get(key)) {
+            REQUIRE(*value == last[key].first);
+            REQUIRE(FakeClock::now() < last[key].second);
+        }
+        REQUIRE(cache.Size() <= 100);
+        FakeClock::current += std::chrono::milliseconds{rnd.GenInt(0, 2)};
+    }
+
+    FakeClock::current += 10s;
+    cache.RemoveExpired();
+    REQUIRE(cache.Size() == 0);
+    REQUIRE(cache.Weight() == 0);
+}
+
+}  // namespace
+
+TEST_CASE("Policies keep values consistent") {
+    CheckConsistency<LruPolicy>();
+    CheckConsistency<TinyLfuPolicy>();
+    CheckConsistency<ArcPolicy>();
+}
+
+TEST_CASE("Policies with weight limit and expiry") {
+    CheckWeightAndExpiry<LruPolicy>();
+    CheckWeightAndExpiry<TinyLfuPolicy>();
+    CheckWeightAndExpiry<ArcPolicy>();
+}
+
+TEST_CASE("Scan evicts hot keys from LRU") {
+    REQUIRE(HotKeysAfterScan<LruPolicy>() == 0);
+}
+
+TEST_CASE("TinyLFU and ARC survive a scan") {
+    REQUIRE(HotKeysAfterScan<TinyLfuPolicy>() >= 450);
+    REQUIRE(HotKeysAfterScan<ArcPolicy>() >= 450);
+}
+
+TEST_CASE("Frequency sketch") {
+    FrequencySketch sketch{100};
+    for (auto i = 0; i < 10; ++i) {
+        sketch.Increment(1);
+    }
+    sketch.Increment(2);
+    REQUIRE(sketch.Frequency(1) >= 10);
+    REQUIRE(sketch.Frequency(2) >= 1);
+    REQUIRE(sketch.Frequency(1) > sketch.Frequency(2));
+
+    for (auto i = 0; i < 1'000; ++i) {
+        sketch.Increment(1'000 + i);
+    }
+    REQUIRE(sketch.Frequency(1) < 10);
+}
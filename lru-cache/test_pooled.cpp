@@ -0,0 +1,303 @@
+#include <fake_clock.h>
+#include <pooled_lru_cache.h>
+#include <lru_cache.h>
+#include <util.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+// Считает выделения памяти, а саму память берет у new_delete_resource.
+class CountingResource : public std::pmr::memory_resource {
+public:
+    size_t Allocations() const {
+        return allocations_;
+    }
+
+private:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        ++allocations_;
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+    }
+
+    void do_deallocate(void* memory, size_t bytes, size_t alignment) override {
+        std::pmr::new_delete_resource()->deallocate(memory, bytes, alignment);
+    }
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    size_t allocations_ = 0;
+};
+
+}  // namespace
+
+TEST_CASE("Pooled set and get") {
+    PooledLruCache<std::string, std::string> cache(10);
+    std::string value;
+
+    cache.Set("a", "1");
+    cache.Set(std::string{"b"}, std::string_view{"2"});
+    REQUIRE(cache.Get("a", &value));
+    REQUIRE(value == "1");
+    REQUIRE(cache.Get(std::string_view{"b"}, &value));
+    REQUIRE(value == "2");
+    REQUIRE_FALSE(cache.Get("c", &value));
+    REQUIRE_FALSE(cache.Get("c"));
+
+    cache.Set("a", "3");
+    const auto* found = cache.Get(std::string_view{"a"});
+    REQUIRE(found);
+    REQUIRE(*found == "3");
+    REQUIRE(cache.Size() == 2);
+}
+
+TEST_CASE("Pooled eviction") {
+    PooledLruCache<std::string, std::string> cache(2);
+    std::string value;
+
+    cache.Set("a", "1");
+    cache.Set("b", "2");
+    cache.Set("c", "3");
+    REQUIRE_FALSE(cache.Get("a", &value));
+    REQUIRE(cache.Get("b", &value));
+    REQUIRE(cache.Get("c", &value));
+
+    cache.Set("b", "4");
+    cache.Set("c", "5");
+    cache.Set("b", "6");
+    cache.Set("e", "7");
+    REQUIRE_FALSE(cache.Get("c", &value));
+    REQUIRE(cache.Get("b", &value));
+    REQUIRE(value == "6");
+    REQUIRE(cache.Get("e", &value));
+
+    cache.Get("b", &value);
+    cache.Set("f", "8");
+    REQUIRE_FALSE(cache.Get("e", &value));
+    REQUIRE(cache.Get("b", &value));
+    REQUIRE(cache.Get("f", &value));
+    REQUIRE(cache.Size() == 2);
+}
+
+TEST_CASE("Pooled integer keys") {
+    constexpr auto kSize = 1'000;
+    PooledLruCache<int, int> cache(kSize);
+    for (auto i = 0; i < 10 * kSize; ++i) {
+        cache.Set(i, -i);
+    }
+    for (auto i = 0; i < 9 * kSize; ++i) {
+        REQUIRE_FALSE(cache.Get(i));
+    }
+    for (auto i = 9 * kSize; i < 10 * kSize; ++i) {
+        REQUIRE(*cache.Get(i) == -i);
+    }
+}
+
+TEST_CASE("Pooled stress") {
+    PooledLruCache<std::string, std::string> cache(100);
+    LruCache expected(100);
+    std::string value;
+    std::string expected_value;
+    RandomGenerator rnd{431'234};
+    for (auto i = 0; i < 100'000; ++i) {
+        auto key = std::to_string(rnd.GenInt(0, 300));
+        if (rnd.GenInt(0, 1)) {
+            cache.Set(key, std::to_string(i));
+            expected.Set(key, std::to_string(i));
+        } else {
+            REQUIRE(cache.Get(key, &value) == expected.Get(key, &expected_value));
+            REQUIRE(value == expected_value);
+        }
+    }
+}
+
+TEST_CASE("Pooled cache does not allocate when full") {
+    constexpr auto kSize = 1'000;
+    // Ключи и значения длиннее буфера короткой строки, так что каждая новая строка
+    // выделяла бы память. Кеш создает их сам из string_view, поэтому память они берут
+    // у ресурса по умолчанию.
+    constexpr std::string_view kValue = "value that does not fit in sso";
+    CountingResource resource;
+    auto* previous = std::pmr::set_default_resource(&resource);
+
+    size_t allocations;
+    auto misses = 0;
+    {
+        PooledLruCache<std::pmr::string, std::pmr::string, LruPolicy, StringHash> cache(kSize);
+        char key[32];
+        auto make_key = [&key](int i) {
+            auto size = std::snprintf(key, sizeof(key), "key-%020d", i);
+            return std::string_view{key, static_cast<size_t>(size)};
+        };
+        for (auto i = 0; i < kSize; ++i) {
+            cache.Set(make_key(i), kValue);
+        }
+
+        auto before = resource.Allocations();
+        for (auto i = kSize; i < 100 * kSize; ++i) {
+            cache.Set(make_key(i), kValue);
+            misses += !cache.Get(make_key(i - 1));
+            misses += !cache.Get(make_key(i - kSize));
+        }
+        allocations = resource.Allocations() - before;
+    }
+    std::pmr::set_default_resource(previous);
+
+    REQUIRE(resource.Allocations() >= 2 * kSize);
+    REQUIRE(allocations == 0);
+    REQUIRE(misses == 99 * kSize);
+}
+
+namespace {
+
+template <class Key, class Value>
+using ExpiringCache =
+    PooledLruCache<Key, Value, LruPolicy, DefaultLruHash<Key>, std::equal_to<>, SizeWeigher,
+                   FakeClock>;
+
+}  // namespace
+
+TEST_CASE("Pooled weight limit") {
+    PooledLruCache<std::string, std::string> cache(100, {.max_weight = 100});
+
+    cache.Set("a", "1", {.weight = 40});
+    cache.Set("b", "2", {.weight = 40});
+    REQUIRE(cache.Weight() == 80);
+    cache.Set("c", "3", {.weight = 40});
+    REQUIRE(cache.Weight() == 80);
+    REQUIRE_FALSE(cache.Get("a"));
+    REQUIRE(cache.Get("b"));
+    REQUIRE(cache.Get("c"));
+
+    cache.Set("b", "4", {.weight = 90});
+    REQUIRE(cache.Weight() == 90);
+    REQUIRE(cache.Size() == 1);
+    REQUIRE(*cache.Get("b") == "4");
+
+    // Запись тяжелее всего бюджета не остается в кеше.
+    cache.Set("d", "5", {.weight = 101});
+    REQUIRE(cache.Size() == 0);
+    REQUIRE(cache.Weight() == 0);
+}
+
+TEST_CASE("Pooled default weigher") {
+    PooledLruCache<std::string, std::string> cache(100);
+    cache.Set("key", std::string(1'000, 'x'));
+    REQUIRE(cache.Weight() == 2 * sizeof(std::string) + 1'003);
+    cache.Set("key", "x");
+    REQUIRE(cache.Weight() == 2 * sizeof(std::string) + 4);
+
+    PooledLruCache<std::string, std::string> small(100, {.max_weight = 10'000});
+    for (auto i = 0; i < 100; ++i) {
+        small.Set(std::to_string(i), std::string(1'000, 'x'));
+        REQUIRE(small.Weight() <= 10'000);
+    }
+    REQUIRE(small.Size() == 10'000 / (2 * sizeof(std::string) + 1'002));
+}
+
+TEST_CASE("Pooled expiry on access") {
+    using namespace std::chrono_literals;
+    ExpiringCache<std::string, int> cache(10, {.ttl = 10s});
+
+    cache.Set("a", 1);
+    cache.Set("b", 2, {.ttl = 30s});
+    cache.Set("c", 3, {.ttl = 0s});
+    FakeClock::current += 5s;
+    REQUIRE(cache.Get("a"));
+
+    FakeClock::current += 6s;
+    REQUIRE_FALSE(cache.Get("a"));
+    REQUIRE(cache.Get("b"));
+    REQUIRE(cache.Size() == 2);
+
+    cache.Set("b", 4);
+    FakeClock::current += 20s;
+    REQUIRE_FALSE(cache.Get("b"));
+    REQUIRE(cache.Get("c"));
+}
+
+TEST_CASE("Pooled expiry sweep") {
+    using namespace std::chrono_literals;
+    constexpr auto kSize = 100;
+    ExpiringCache<int, int> cache(2 * kSize);
+
+    for (auto i = 0; i < kSize; ++i) {
+        cache.Set(i, i, {.ttl = 1s});
+    }
+    FakeClock::current += 2s;
+    // Никто не обращается к истекшим записям, но каждый Set проверяет пару узлов.
+    for (auto i = kSize; i < 2 * kSize; ++i) {
+        cache.Set(i, i);
+    }
+    REQUIRE(cache.Size() == kSize);
+
+    for (auto i = 0; i < kSize; ++i) {
+        cache.Set(i, i, {.ttl = 1s});
+    }
+    FakeClock::current += 2s;
+    cache.RemoveExpired();
+    REQUIRE(cache.Size() == kSize);
+    for (auto i = kSize; i < 2 * kSize; ++i) {
+        REQUIRE(cache.Get(i));
+    }
+}
+
+TEST_CASE("Pooled metrics") {
+    using namespace std::chrono_literals;
+    ExpiringCache<int, int> cache(kAgeSampleInterval, {.metrics = true});
+
+    for (auto i = 0; i < static_cast<int>(kAgeSampleInterval); ++i) {
+        cache.Set(i, i);
+    }
+    cache.Set(0, 1);
+    cache.Set(1, 1, {.ttl = 1s});
+    REQUIRE(cache.Get(0));
+    REQUIRE_FALSE(cache.Get(-1));
+
+    // Каждая kAgeSampleInterval-я вставка засекает время: здесь это ключ 15.
+    FakeClock::current += 5ms;
+    for (auto i = 0; i < static_cast<int>(kAgeSampleInterval); ++i) {
+        cache.Set(100 + i, i);
+    }
+    FakeClock::current += 2s;
+    cache.RemoveExpired();
+
+    auto metrics = cache.GetMetrics();
+    REQUIRE(metrics.hits == 1);
+    REQUIRE(metrics.misses == 1);
+    REQUIRE(metrics.inserts == 2 * kAgeSampleInterval);
+    REQUIRE(metrics.updates == 2);
+    REQUIRE(metrics.evictions == kAgeSampleInterval);
+    REQUIRE(metrics.expirations == 0);
+    REQUIRE(metrics.size == kAgeSampleInterval);
+    REQUIRE(metrics.weight == kAgeSampleInterval * 2 * sizeof(int));
+    REQUIRE(metrics.eviction_age[3] == 1);
+
+    auto text = metrics.ToText();
+    REQUIRE(text.find("hits 1\n") != std::string::npos);
+    REQUIRE(text.find("evictions 16\n") != std::string::npos);
+    REQUIRE(text.find("eviction_age_ms <8 1\n") != std::string::npos);
+    auto json = metrics.ToJson();
+    REQUIRE(json.starts_with("{\"hits\": 1, \"misses\": 1, \"inserts\": 32, "));
+    REQUIRE(json.ends_with("\"eviction_age_ms\": [0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, "
+                           "0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0]}"));
+}
+
+TEST_CASE("Pooled metrics are off by default") {
+    PooledLruCache<int, int> cache(1);
+    cache.Set(1, 1);
+    cache.Set(2, 2);
+    cache.Get(2);
+    auto metrics = cache.GetMetrics();
+    REQUIRE(metrics.hits == 0);
+    REQUIRE(metrics.evictions == 0);
+    REQUIRE(metrics.size == 1);
+}
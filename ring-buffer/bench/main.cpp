@@ -0,0 +1,169 @@
+#include <mpmc_ring_buffer.h>
+#include <ring_buffer.h>
+#include <spsc_ring_buffer.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include <thread>
+#include <vector>
+
+// Передача элементов между двумя потоками через кольцевые очереди.
+// Пропускная способность: писатель кладет kCount чисел в очередь на kCapacity элементов,
+// читатель забирает их. Задержка: два потока перекидывают число по двум очередям
+// туда и обратно, в таблице - половина времени круга. Пока очередь полна или пуста,
+// потоки уступают процессор, чтобы замеры имели смысл и на одном ядре. Последняя строка -
+// SpscRingBuffer с передачей пачками.
+// Запускать в Release.
+
+namespace {
+
+constexpr size_t kCapacity = 1024;
+constexpr int kCount = 10'000'000;
+constexpr int kRoundTrips = 100'000;
+constexpr size_t kBatchSize = 64;
+
+// Исходный RingBuffer под одной блокировкой.
+class MutexRingBuffer {
+public:
+    explicit MutexRingBuffer(size_t capacity) : buffer_{capacity} {
+    }
+
+    bool TryPush(int element) {
+        std::lock_guard lock{mutex_};
+        return buffer_.TryPush(element);
+    }
+
+    bool TryPop(int* element) {
+        std::lock_guard lock{mutex_};
+        return buffer_.TryPop(element);
+    }
+
+private:
+    std::mutex mutex_;
+    RingBuffer buffer_;
+};
+
+template <class Buffer>
+void Push(Buffer* buffer, int element) {
+    while (!buffer->TryPush(element)) {
+        std::this_thread::yield();
+    }
+}
+
+template <class Buffer>
+int Pop(Buffer* buffer) {
+    int element;
+    while (!buffer->TryPop(&element)) {
+        std::this_thread::yield();
+    }
+    return element;
+}
+
+// Миллионов элементов в секунду.
+template <class Buffer>
+double Throughput() {
+    Buffer buffer{kCapacity};
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer{[&buffer] {
+        for (auto i = 0; i < kCount; ++i) {
+            Push(&buffer, i);
+        }
+    }};
+    int64_t sum = 0;
+    for (auto i = 0; i < kCount; ++i) {
+        sum += Pop(&buffer);
+    }
+    producer.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (sum != int64_t{kCount} * (kCount - 1) / 2) {
+        std::fprintf(stderr, "lost elements\n");
+    }
+    return kCount / elapsed.count() / 1e6;
+}
+
+// То же пачками по kBatchSize через TryPushN и TryPopN.
+double BatchThroughput() {
+    SpscRingBuffer<int> buffer{kCapacity};
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer{[&buffer] {
+        std::vector<int> batch(kBatchSize);
+        for (auto i = 0; i < kCount;) {
+            auto size = std::min<size_t>(kBatchSize, kCount - i);
+            std::iota(batch.begin(), batch.begin() + size, i);
+            for (size_t pushed = 0; pushed < size;) {
+                auto count = buffer.TryPushN(std::span{batch}.subspan(pushed, size - pushed));
+                if (!count) {
+                    std::this_thread::yield();
+                }
+                pushed += count;
+            }
+            i += size;
+        }
+    }};
+    int64_t sum = 0;
+    std::vector<int> batch(kBatchSize);
+    for (auto i = 0; i < kCount;) {
+        auto count = buffer.TryPopN(batch);
+        if (!count) {
+            std::this_thread::yield();
+        }
+        sum = std::accumulate(batch.begin(), batch.begin() + count, sum);
+        i += count;
+    }
+    producer.join();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    if (sum != int64_t{kCount} * (kCount - 1) / 2) {
+        std::fprintf(stderr, "lost elements\n");
+    }
+    return kCount / elapsed.count() / 1e6;
+}
+
+struct Latency {
+    double median;
+    double p99;
+};
+
+// В наносекундах.
+template <class Buffer>
+Latency PingPong() {
+    Buffer ping{kCapacity};
+    Buffer pong{kCapacity};
+    std::thread echo{[&ping, &pong] {
+        for (auto i = 0; i < kRoundTrips; ++i) {
+            Push(&pong, Pop(&ping));
+        }
+    }};
+    std::vector<double> times(kRoundTrips);
+    for (auto i = 0; i < kRoundTrips; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        Push(&ping, i);
+        Pop(&pong);
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        times[i] = elapsed.count() / 2;
+    }
+    echo.join();
+    std::ranges::sort(times);
+    return {times[times.size() / 2], times[times.size() * 99 / 100]};
+}
+
+template <class Buffer>
+void Report(const char* name) {
+    auto throughput = Throughput<Buffer>();
+    auto [median, p99] = PingPong<Buffer>();
+    std::printf("%-10s %12.2f %12.0f %12.0f\n", name, throughput, median, p99);
+}
+
+}  // namespace
+
+int main() {
+    std::printf("%-10s %12s %12s %12s\n", "buffer", "Mitems/s", "median ns", "p99 ns");
+    Report<MutexRingBuffer>("mutex");
+    Report<SpscRingBuffer<int>>("spsc");
+    Report<MpmcRingBuffer<int>>("mpmc");
+    std::printf("%-10s %12.2f\n", "spsc batch", BatchThroughput());
+}
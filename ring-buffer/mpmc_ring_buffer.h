@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// Ограниченная очередь без блокировок для любого числа писателей и читателей
+// (схема Вьюкова). Емкость округляется вверх до степени двойки, но не меньше 2.
+//
+// У каждой ячейки есть номер sequence. Ячейка свободна для записи с позиции position,
+// когда sequence == position, и готова к чтению, когда sequence == position + 1.
+// Писатели сначала занимают позицию, сдвигая tail_ через CAS, потом пишут значение
+// и публикуют его, сдвигая sequence ячейки; читатели - так же с head_. Поэтому потоки
+// соревнуются только за индекс, а значение в ячейке в каждый момент трогает один поток.
+template <class T>
+class MpmcRingBuffer {
+public:
+    explicit MpmcRingBuffer(size_t capacity)
+        : capacity_{std::bit_ceil(std::max<size_t>(capacity, 2))},
+          mask_{capacity_ - 1},
+          slots_{std::make_unique<Slot[]>(capacity_)} {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcRingBuffer(const MpmcRingBuffer&) = delete;
+    MpmcRingBuffer& operator=(const MpmcRingBuffer&) = delete;
+
+    template <class U>
+    bool TryPush(U&& element) {
+        auto position = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = slots_[position & mask_];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(sequence - position);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+                    slot.value = std::forward<U>(element);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                // Ячейку круг назад еще не прочитали - очередь полна.
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    bool TryPop(T* element) {
+        auto position = head_.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = slots_[position & mask_];
+            auto sequence = slot.sequence.load(std::memory_order_acquire);
+            auto diff = static_cast<int64_t>(sequence - (position + 1));
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(position, position + 1,
+                                                std::memory_order_relaxed)) {
+                    *element = std::move(slot.value);
+                    slot.sequence.store(position + capacity_, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Из других потоков, пока очередь меняется, - только приблизительно.
+    size_t Size() const {
+        auto head = head_.load(std::memory_order_acquire);
+        auto tail = tail_.load(std::memory_order_acquire);
+        return tail > head ? tail - head : 0;
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    size_t Capacity() const {
+        return capacity_;
+    }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    size_t capacity_;
+    size_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(kCacheLineSize) std::atomic<size_t> head_ = 0;
+    alignas(kCacheLineSize) std::atomic<size_t> tail_ = 0;
+};
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Кольцевая очередь без блокировок для одного писателя и одного читателя: TryPush
+// вызывает только один поток, TryPop - только один другой. Емкость округляется вверх
+// до степени двойки, чтобы позиция в буфере считалась маской, а не делением.
+//
+// Индексы только растут. Писатель владеет tail_, читатель - head_, они лежат в разных
+// кеш-линиях. Кроме того, каждый помнит последнее увиденное значение чужого индекса
+// и перечитывает настоящее, только когда по запомненному очередь полна (пуста), так что
+// пока очередь не у края, потоки не трогают кеш-линию друг друга.
+//
+// Пачками элементы передаются через TryPushN и TryPopN, а без копирования - через
+// резервирование: ReserveWrite отдает писателю свободные ячейки буфера, в которые он пишет
+// на месте и публикует их CommitWrite; ReserveRead и CommitRead - то же для читателя.
+// Индекс сдвигается один раз на всю пачку.
+template <class T>
+class SpscRingBuffer {
+public:
+    explicit SpscRingBuffer(size_t capacity)
+        : buffer_(std::bit_ceil(std::max<size_t>(capacity, 1))), mask_{buffer_.size() - 1} {
+    }
+
+    // Не больше двух непрерывных кусков буфера: второй начинается с начала буфера
+    // и непуст, только если область переходит через его конец.
+    struct Region {
+        std::span<T> first;
+        std::span<T> second;
+
+        size_t Size() const {
+            return first.size() + second.size();
+        }
+    };
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    template <class U>
+    bool TryPush(U&& element) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (tail - cached_head_ == buffer_.size()) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - cached_head_ == buffer_.size()) {
+                return false;
+            }
+        }
+        buffer_[tail & mask_] = std::forward<U>(element);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T* element) {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (head == cached_tail_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == cached_tail_) {
+                return false;
+            }
+        }
+        *element = std::move(buffer_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Кладет столько первых элементов, сколько поместится, и возвращает их число.
+    size_t TryPushN(std::span<const T> elements) {
+        auto region = ReserveWrite(elements.size());
+        std::ranges::copy(elements.first(region.first.size()), region.first.begin());
+        std::ranges::copy(elements.subspan(region.first.size(), region.second.size()),
+                          region.second.begin());
+        CommitWrite(region.Size());
+        return region.Size();
+    }
+
+    // Забирает до elements.size() элементов и возвращает их число.
+    size_t TryPopN(std::span<T> elements) {
+        auto region = ReserveRead(elements.size());
+        std::ranges::move(region.first, elements.begin());
+        std::ranges::move(region.second, elements.begin() + region.first.size());
+        CommitRead(region.Size());
+        return region.Size();
+    }
+
+    // До count свободных ячеек, меньше - если столько нет. Вызывает только писатель.
+    Region ReserveWrite(size_t count) {
+        auto tail = tail_.load(std::memory_order_relaxed);
+        if (buffer_.size() - (tail - cached_head_) < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+        return GetRegion(tail, std::min(count, buffer_.size() - (tail - cached_head_)));
+    }
+
+    // Делает видимыми читателю первые count ячеек из последнего ReserveWrite.
+    void CommitWrite(size_t count) {
+        tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // До count готовых к чтению элементов. Вызывает только читатель.
+    Region ReserveRead(size_t count) {
+        auto head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        return GetRegion(head, std::min(count, cached_tail_ - head));
+    }
+
+    // Освобождает для писателя первые count элементов из последнего ReserveRead.
+    void CommitRead(size_t count) {
+        head_.store(head_.load(std::memory_order_relaxed) + count, std::memory_order_release);
+    }
+
+    // Из других потоков, пока очередь меняется, - только приблизительно.
+    size_t Size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    bool Empty() const {
+        return Size() == 0;
+    }
+
+    size_t Capacity() const {
+        return buffer_.size();
+    }
+
+private:
+    static constexpr size_t kCacheLineSize = 64;
+
+    Region GetRegion(size_t position, size_t count) {
+        auto offset = position & mask_;
+        auto first = std::min(count, buffer_.size() - offset);
+        return {{buffer_.data() + offset, first}, {buffer_.data(), count - first}};
+    }
+
+    std::vector<T> buffer_;
+    size_t mask_;
+    // Читатель.
+    alignas(kCacheLineSize) std::atomic<size_t> head_ = 0;
+    size_t cached_tail_ = 0;
+    // Писатель.
+    alignas(kCacheLineSize) std::atomic<size_t> tail_ = 0;
+    size_t cached_head_ = 0;
+};
@@ -0,0 +1,234 @@
+#include <mpmc_ring_buffer.h>
+#include <spsc_ring_buffer.h>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+template <class Buffer>
+void CheckSingleThread() {
+    Buffer buffer(3);
+    REQUIRE(buffer.Capacity() == 4);
+    REQUIRE(buffer.Empty());
+
+    for (auto i = 0; i < 4; ++i) {
+        REQUIRE(buffer.TryPush(std::to_string(i)));
+    }
+    REQUIRE_FALSE(buffer.TryPush("4"));
+    REQUIRE(buffer.Size() == 4);
+
+    // Несколько кругов по буферу.
+    std::string element;
+    for (auto i = 0; i < 100; ++i) {
+        REQUIRE(buffer.TryPop(&element));
+        REQUIRE(element == std::to_string(i));
+        REQUIRE(buffer.TryPush(std::to_string(i + 4)));
+        REQUIRE_FALSE(buffer.TryPush("x"));
+    }
+    for (auto i = 100; i < 104; ++i) {
+        REQUIRE(buffer.TryPop(&element));
+        REQUIRE(element == std::to_string(i));
+    }
+    REQUIRE_FALSE(buffer.TryPop(&element));
+    REQUIRE(buffer.Empty());
+}
+
+}  // namespace
+
+TEST_CASE("Lock-free buffers in one thread") {
+    CheckSingleThread<SpscRingBuffer<std::string>>();
+    CheckSingleThread<MpmcRingBuffer<std::string>>();
+}
+
+TEST_CASE("Lock-free buffers move elements") {
+    SpscRingBuffer<std::unique_ptr<int>> spsc(1);
+    REQUIRE(spsc.Capacity() == 1);
+    REQUIRE(spsc.TryPush(std::make_unique<int>(1)));
+    REQUIRE_FALSE(spsc.TryPush(std::make_unique<int>(2)));
+
+    MpmcRingBuffer<std::unique_ptr<int>> mpmc(1);
+    REQUIRE(mpmc.Capacity() == 2);
+    REQUIRE(mpmc.TryPush(std::make_unique<int>(1)));
+
+    std::unique_ptr<int> element;
+    REQUIRE(spsc.TryPop(&element));
+    REQUIRE(*element == 1);
+    REQUIRE(mpmc.TryPop(&element));
+    REQUIRE(*element == 1);
+}
+
+TEST_CASE("SPSC keeps order") {
+    constexpr auto kCount = 1'000'000;
+    SpscRingBuffer<int> buffer(64);
+
+    std::thread producer{[&buffer] {
+        for (auto i = 0; i < kCount; ++i) {
+            while (!buffer.TryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    }};
+
+    auto errors = 0;
+    for (auto i = 0; i < kCount; ++i) {
+        int element;
+        while (!buffer.TryPop(&element)) {
+            std::this_thread::yield();
+        }
+        errors += element != i;
+    }
+    producer.join();
+
+    REQUIRE(errors == 0);
+    REQUIRE(buffer.Empty());
+}
+
+TEST_CASE("MPMC delivers every element once") {
+    constexpr auto kThreads = 4;
+    constexpr auto kCount = 200'000;
+    MpmcRingBuffer<int> buffer(64);
+
+    std::vector<std::thread> threads;
+    std::atomic<int> popped = 0;
+    std::vector<std::vector<int>> received(kThreads);
+    for (auto i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&buffer, i] {
+            for (auto j = i; j < kThreads * kCount; j += kThreads) {
+                while (!buffer.TryPush(j)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+        threads.emplace_back([&buffer, &popped, &received, i] {
+            int element;
+            while (popped.load() < kThreads * kCount) {
+                if (buffer.TryPop(&element)) {
+                    received[i].push_back(element);
+                    ++popped;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::vector<int> seen(kThreads * kCount);
+    auto ordered = true;
+    for (const auto& elements : received) {
+        // Элементы одного писателя читатель видит в порядке записи.
+        std::vector<int> last(kThreads, -1);
+        for (auto element : elements) {
+            ordered &= element > last[element % kThreads];
+            last[element % kThreads] = element;
+            ++seen[element];
+        }
+    }
+    REQUIRE(ordered);
+    REQUIRE(std::ranges::all_of(seen, [](auto count) { return count == 1; }));
+}
+
+TEST_CASE("SPSC batches") {
+    SpscRingBuffer<int> buffer(8);
+    std::vector<int> input(10);
+    std::iota(input.begin(), input.end(), 0);
+
+    REQUIRE(buffer.TryPushN(input) == 8);
+    REQUIRE(buffer.TryPushN(input) == 0);
+
+    std::vector<int> output(5);
+    REQUIRE(buffer.TryPopN(output) == 5);
+    REQUIRE(output == std::vector{0, 1, 2, 3, 4});
+
+    // Пачка переходит через конец буфера.
+    REQUIRE(buffer.TryPushN(std::span{input}.subspan(8)) == 2);
+    output.resize(10);
+    REQUIRE(buffer.TryPopN(output) == 5);
+    output.resize(5);
+    REQUIRE(output == std::vector{5, 6, 7, 8, 9});
+    REQUIRE(buffer.TryPopN(output) == 0);
+    REQUIRE(buffer.Empty());
+}
+
+TEST_CASE("SPSC reservation") {
+    SpscRingBuffer<int> buffer(4);
+
+    auto region = buffer.ReserveWrite(3);
+    REQUIRE(region.Size() == 3);
+    REQUIRE(region.second.empty());
+    std::iota(region.first.begin(), region.first.end(), 0);
+    // Пока не опубликовано, читатель ничего не видит.
+    REQUIRE(buffer.ReserveRead(4).Size() == 0);
+    buffer.CommitWrite(3);
+
+    region = buffer.ReserveRead(2);
+    REQUIRE(region.first.size() == 2);
+    REQUIRE(region.first[0] == 0);
+    REQUIRE(region.first[1] == 1);
+    buffer.CommitRead(2);
+
+    // Свободны последняя ячейка и две первые.
+    region = buffer.ReserveWrite(10);
+    REQUIRE(region.first.size() == 1);
+    REQUIRE(region.second.size() == 2);
+    region.first[0] = 3;
+    region.second[0] = 4;
+    buffer.CommitWrite(2);
+    REQUIRE(buffer.Size() == 3);
+
+    region = buffer.ReserveRead(10);
+    REQUIRE(region.first.size() == 2);
+    REQUIRE(region.second.size() == 1);
+    REQUIRE(region.first[0] == 2);
+    REQUIRE(region.first[1] == 3);
+    REQUIRE(region.second[0] == 4);
+    buffer.CommitRead(3);
+    REQUIRE(buffer.Empty());
+}
+
+TEST_CASE("SPSC batches keep order") {
+    constexpr auto kCount = 1'000'000;
+    SpscRingBuffer<int> buffer(64);
+
+    std::thread producer{[&buffer] {
+        std::vector<int> batch(37);
+        for (auto i = 0; i < kCount;) {
+            auto size = std::min<size_t>(batch.size(), kCount - i);
+            std::iota(batch.begin(), batch.begin() + size, i);
+            auto pushed = buffer.TryPushN(std::span{batch}.first(size));
+            if (!pushed) {
+                std::this_thread::yield();
+            }
+            i += pushed;
+        }
+    }};
+
+    auto errors = 0;
+    for (auto i = 0; i < kCount;) {
+        auto region = buffer.ReserveRead(50);
+        if (!region.Size()) {
+            std::this_thread::yield();
+            continue;
+        }
+        for (auto part : {region.first, region.second}) {
+            for (auto element : part) {
+                errors += element != i++;
+            }
+        }
+        buffer.CommitRead(region.Size());
+    }
+    producer.join();
+
+    REQUIRE(errors == 0);
+    REQUIRE(buffer.Empty());
+}
@@ -0,0 +1,58 @@
+#include <ast.h>
+#include <error.h>
+
+#include <algorithm>
+
+std::string_view Arena::MakeString(std::string_view string) {
+    auto* data = static_cast<char*>(Allocate(string.size(), 1));
+    std::copy(string.begin(), string.end(), data);
+    return {data, string.size()};
+}
+
+size_t Arena::GetBytesAllocated() const {
+    return bytes_allocated_;
+}
+
+void* Arena::Allocate(size_t size, size_t alignment) {
+    auto space = static_cast<size_t>(end_ - current_);
+    void* memory = current_;
+    if (!current_ || !std::align(alignment, size, memory, space)) {
+        auto block_size = std::max(kMinBlockSize << blocks_.size(), size + alignment);
+        current_ = blocks_.emplace_back(new std::byte[block_size]).get();
+        end_ = current_ + block_size;
+        space = block_size;
+        memory = current_;
+        std::align(alignment, size, memory, space);
+    }
+    current_ = static_cast<std::byte*>(memory) + size;
+    bytes_allocated_ += size;
+    return memory;
+}
+
+std::shared_ptr<Object> ToObject(const Node* node) {
+    if (const auto* number = As<NumberNode>(node)) {
+        return std::make_shared<Number>(number->value);
+    } else if (As<BignumNode>(node)) {
+        // В object.h нет длинных чисел.
+        throw SyntaxError{"Number literal is too large"};
+    } else if (const auto* symbol = As<SymbolNode>(node)) {
+        return std::make_shared<Symbol>(symbol->id);
+    } else if (const auto* boolean = As<BooleanNode>(node)) {
+        return MakeBoolean(boolean->value);
+    } else if (As<CellNode>(node)) {
+        std::shared_ptr<Object> head;
+        std::shared_ptr<Cell> tail;
+        for (; const auto* cell = As<CellNode>(node); node = cell->second) {
+            auto next = std::make_shared<Cell>(ToObject(cell->first), nullptr);
+            if (tail) {
+                tail->SetSecond(next);
+            } else {
+                head = next;
+            }
+            tail = std::move(next);
+        }
+        tail->SetSecond(ToObject(node));
+        return head;
+    }
+    return nullptr;
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <object.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Бамп-аллокатор для узлов AST. Память отдается только целиком, вместе с ареной,
+// поэтому в ней можно размещать лишь объекты без деструкторов.
+class Arena {
+public:
+    Arena() = default;
+    Arena(Arena&&) = default;
+    Arena& operator=(Arena&&) = default;
+
+    template <class T, class... Args>
+    T* Make(Args&&... args) {
+        static_assert(std::is_trivially_destructible_v<T>);
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Копия строки в арене.
+    std::string_view MakeString(std::string_view string);
+
+    size_t GetBytesAllocated() const;
+
+private:
+    static constexpr size_t kMinBlockSize = 4 << 10;
+
+    void* Allocate(size_t size, size_t alignment);
+
+    std::vector<std::unique_ptr<std::byte[]>> blocks_;
+    std::byte* current_ = nullptr;
+    std::byte* end_ = nullptr;
+    size_t bytes_allocated_ = 0;
+};
+
+// Узлы AST в арене. Пустой список - nullptr, как и в shared_ptr-версии из object.h.
+enum class NodeType : uint8_t { kNumber, kBignum, kSymbol, kBoolean, kCell };
+
+struct Node {
+    explicit Node(NodeType type) : type{type} {
+    }
+
+    NodeType type;
+};
+
+struct NumberNode : Node {
+    static constexpr auto kType = NodeType::kNumber;
+
+    explicit NumberNode(int64_t value) : Node{kType}, value{value} {
+    }
+
+    int64_t value;
+};
+
+// Литерал за пределами int64_t, цифры лежат в арене.
+struct BignumNode : Node {
+    static constexpr auto kType = NodeType::kBignum;
+
+    explicit BignumNode(std::string_view digits) : Node{kType}, digits{digits} {
+    }
+
+    std::string_view digits;
+};
+
+struct SymbolNode : Node {
+    static constexpr auto kType = NodeType::kSymbol;
+
+    explicit SymbolNode(uint32_t id) : Node{kType}, id{id} {
+    }
+
+    uint32_t id;
+};
+
+struct BooleanNode : Node {
+    static constexpr auto kType = NodeType::kBoolean;
+
+    explicit BooleanNode(bool value) : Node{kType}, value{value} {
+    }
+
+    bool value;
+};
+
+struct CellNode : Node {
+    static constexpr auto kType = NodeType::kCell;
+
+    CellNode(const Node* first, const Node* second) : Node{kType}, first{first}, second{second} {
+    }
+
+    const Node* first;
+    const Node* second;
+};
+
+template <class T>
+const T* As(const Node* node) {
+    return node && node->type == T::kType ? static_cast<const T*>(node) : nullptr;
+}
+
+// Разобранное выражение вместе с памятью под него. Освобождается за число блоков арены,
+// не обходя узлы.
+struct SyntaxTree {
+    Arena arena;
+    const Node* root = nullptr;
+};
+
+// Копия в виде дерева из object.h.
+std::shared_ptr<Object> ToObject(const Node* node);
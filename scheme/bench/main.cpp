@@ -0,0 +1,121 @@
+#include <scheme.h>
+
+#include <sys/resource.h>
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Фиксированный набор программ для сравнения изменений интерпретатора между собой.
+// Каждая программа выполняется в свежем интерпретаторе: сначала setup, затем
+// iterations раз выражение expression. Запуск с аргументом оставляет только программы,
+// в названии которых он встречается; --incremental включает инкрементальную сборку.
+
+namespace {
+
+struct Benchmark {
+    std::string name;
+    std::vector<std::string> setup;
+    std::string expression;
+    int iterations;
+};
+
+std::string MakeLiteral(int size) {
+    std::string literal = "'(";
+    for (auto i = 0; i < size; ++i) {
+        literal += "(" + std::to_string(i) + " sym-" + std::to_string(i % 100) + " #t) ";
+    }
+    return literal + ")";
+}
+
+std::vector<Benchmark> MakeBenchmarks() {
+    return {
+        {"fib",
+         {"(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))"},
+         "(fib 22)",
+         10},
+        {"tail-loop",
+         {"(define (loop i acc) (if (= i 0) acc (loop (- i 1) (+ acc 1))))"},
+         "(loop 1000000 0)",
+         10},
+        {"list-build",
+         {"(define (build n acc) (if (= n 0) acc (build (- n 1) (cons n acc))))"},
+         "(car (list-tail (build 100000 '()) 99990))",
+         50},
+        {"list-builtins",
+         {"(define (sum xs acc) (if (null? xs) acc (sum (cdr xs) (+ acc (car xs)))))"},
+         "(sum (list 1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16) (list-ref '(1 2 3) 2))",
+         100000},
+        {"quote-literal", {}, MakeLiteral(5000), 100},
+        {"closures",
+         {"(define (make-adder n) (lambda (x) (+ x n)))",
+          "(define (compose n f) "
+          "  (if (= n 0) f (compose (- n 1) (lambda (x) ((make-adder n) (f x))))))"},
+         "((compose 10000 (lambda (x) x)) 0)",
+         50},
+        {"counters",
+         {"(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))",
+          "(define (run c i) (if (= i 0) (c) (begin (c) (run c (- i 1)))))"},
+         "(run (make-counter) 100000)",
+         20},
+    };
+}
+
+int64_t PeakRssKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+void Run(const Benchmark& benchmark, bool incremental) {
+    Scheme scheme;
+    scheme.SetIncrementalGc(incremental);
+    for (const auto& expression : benchmark.setup) {
+        scheme.Evaluate(expression);
+    }
+    auto before = scheme.GetGcStats();
+
+    auto start = std::chrono::steady_clock::now();
+    std::string result;
+    for (auto i = 0; i < benchmark.iterations; ++i) {
+        result = scheme.Evaluate(benchmark.expression);
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    const auto& stats = scheme.GetGcStats();
+    auto iterations = static_cast<double>(benchmark.iterations);
+    auto allocations = static_cast<double>(stats.allocations - before.allocations);
+    auto bytes = static_cast<double>(stats.bytes_allocated - before.bytes_allocated);
+    std::chrono::duration<double, std::milli> pause = stats.total_pause - before.total_pause;
+    std::chrono::duration<double, std::micro> max_pause = stats.max_pause;
+    std::printf("%-14s %12.1f %12.0f %12.0f %8zu %10.2f %10.1f %10" PRId64 "  %s\n",
+                benchmark.name.c_str(), iterations / elapsed.count(), allocations / iterations,
+                bytes / iterations, stats.collections - before.collections, pause.count(),
+                max_pause.count(), PeakRssKb(), result.substr(0, 16).c_str());
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::string_view filter;
+    auto incremental = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "--incremental") {
+            incremental = true;
+        } else {
+            filter = arg;
+        }
+    }
+    std::printf("%-14s %12s %12s %12s %8s %10s %10s %10s  %s\n", "benchmark", "ops/s",
+                "allocs/op", "bytes/op", "gcs", "gc ms", "max gc us", "rss kb", "result");
+    for (const auto& benchmark : MakeBenchmarks()) {
+        if (benchmark.name.find(filter) != std::string::npos) {
+            Run(benchmark, incremental);
+        }
+    }
+}
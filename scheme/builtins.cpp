@@ -0,0 +1,402 @@
+#include <builtins.h>
+#include <procedure.h>
+#include <error.h>
+#include <hash_table.h>
+#include <numbers.h>
+#include <symbols.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <span>
+
+namespace {
+
+using Args = std::span<const Value>;
+
+void CheckArity(Args args, size_t min, size_t max) {
+    if (args.size() < min || args.size() > max) {
+        throw RuntimeError{"Wrong number of arguments"};
+    }
+}
+
+void CheckArity(Args args, size_t count) {
+    CheckArity(args, count, count);
+}
+
+Value GetNumber(Value value) {
+    if (IsNumber(value)) {
+        return value;
+    }
+    throw RuntimeError{"Expected number, got " + ToString(value)};
+}
+
+// Индексы списков и векторов не бывают больше fixnum.
+int64_t GetIndex(Value value) {
+    if (value.IsFixnum()) {
+        return value.GetFixnum();
+    }
+    if (IsNumber(value)) {
+        throw RuntimeError{"Index out of range"};
+    }
+    throw RuntimeError{"Expected number, got " + ToString(value)};
+}
+
+Pair* GetPair(Value value) {
+    if (auto* pair = value.As<Pair>()) {
+        return pair;
+    }
+    throw RuntimeError{"Expected pair, got " + ToString(value)};
+}
+
+// Объекты замороженной прелюдии (см. Prelude) доступны только для чтения.
+void CheckMutable(const HeapObject* object) {
+    if (object->frozen) {
+        throw RuntimeError{"Cannot modify an immutable object"};
+    }
+}
+
+Vector* GetVector(Value value) {
+    if (auto* vector = value.As<Vector>()) {
+        return vector;
+    }
+    throw RuntimeError{"Expected vector, got " + ToString(value)};
+}
+
+HashTable* GetHashTable(Value value) {
+    if (auto* table = value.As<HashTable>()) {
+        return table;
+    }
+    throw RuntimeError{"Expected hash table, got " + ToString(value)};
+}
+
+Value GetKey(Value value) {
+    if (HashTable::IsValidKey(value)) {
+        return value;
+    }
+    throw RuntimeError{"Expected number or symbol as a key, got " + ToString(value)};
+}
+
+template <class Predicate>
+Value TypePredicate(Args args, Predicate predicate) {
+    CheckArity(args, 1);
+    return Value::MakeBool(std::invoke(predicate, args[0]));
+}
+
+template <class T>
+bool IsA(Value value) {
+    return value.Is<T>();
+}
+
+template <class Order>
+Value Comparison(Heap*, Args args) {
+    for (auto arg : args) {
+        GetNumber(arg);
+    }
+    for (size_t i = 1; i < args.size(); ++i) {
+        if (!Order{}(Compare(args[i - 1], args[i]), 0)) {
+            return Value::MakeBool(false);
+        }
+    }
+    return Value::MakeBool(true);
+}
+
+using Operation = Value (*)(Heap*, Value, Value);
+
+template <Operation kOperation>
+Value Fold(Heap* heap, Args args, Value init) {
+    auto result = init;
+    for (auto arg : args) {
+        result = kOperation(heap, result, GetNumber(arg));
+    }
+    return result;
+}
+
+template <Operation kOperation>
+Value FoldFirst(Heap* heap, Args args) {
+    if (args.empty()) {
+        throw RuntimeError{"Wrong number of arguments"};
+    }
+    return Fold<kOperation>(heap, args.subspan(1), GetNumber(args[0]));
+}
+
+Value Max(Heap*, Value lhs, Value rhs) {
+    return Compare(lhs, rhs) < 0 ? rhs : lhs;
+}
+
+Value Min(Heap*, Value lhs, Value rhs) {
+    return Compare(rhs, lhs) < 0 ? rhs : lhs;
+}
+
+Value Abs(Heap* heap, Args args) {
+    CheckArity(args, 1);
+    auto value = GetNumber(args[0]);
+    return IsNegative(value) ? Negate(heap, value) : value;
+}
+
+Value Not(Heap*, Args args) {
+    CheckArity(args, 1);
+    return Value::MakeBool(!IsTrue(args[0]));
+}
+
+bool IsList(Value value) {
+    while (const auto* pair = value.As<Pair>()) {
+        value = pair->second;
+    }
+    return value.IsNil();
+}
+
+Value Cons(Heap* heap, Args args) {
+    CheckArity(args, 2);
+    return heap->MakePair(args[0], args[1]);
+}
+
+Value Car(Heap*, Args args) {
+    CheckArity(args, 1);
+    return GetPair(args[0])->first;
+}
+
+Value Cdr(Heap*, Args args) {
+    CheckArity(args, 1);
+    return GetPair(args[0])->second;
+}
+
+Value SetCar(Heap* heap, Args args) {
+    CheckArity(args, 2);
+    auto* pair = GetPair(args[0]);
+    CheckMutable(pair);
+    heap->WriteBarrier(args[1]);
+    pair->first = args[1];
+    return {};
+}
+
+Value SetCdr(Heap* heap, Args args) {
+    CheckArity(args, 2);
+    auto* pair = GetPair(args[0]);
+    CheckMutable(pair);
+    heap->WriteBarrier(args[1]);
+    pair->second = args[1];
+    return {};
+}
+
+Value List(Heap* heap, Args args) {
+    Value result;
+    for (auto it = args.rbegin(); it != args.rend(); ++it) {
+        result = heap->MakePair(*it, result);
+    }
+    return result;
+}
+
+Value Tail(Value list, int64_t index) {
+    if (index < 0) {
+        throw RuntimeError{"Negative list index"};
+    }
+    for (; index > 0; --index) {
+        const auto* pair = list.As<Pair>();
+        if (!pair) {
+            throw RuntimeError{"List index out of range"};
+        }
+        list = pair->second;
+    }
+    return list;
+}
+
+Value ListTail(Heap*, Args args) {
+    CheckArity(args, 2);
+    return Tail(args[0], GetIndex(args[1]));
+}
+
+Value ListRef(Heap*, Args args) {
+    CheckArity(args, 2);
+    const auto* pair = Tail(args[0], GetIndex(args[1])).As<Pair>();
+    if (!pair) {
+        throw RuntimeError{"List index out of range"};
+    }
+    return pair->first;
+}
+
+Value MakeVector(Heap* heap, Args args) {
+    CheckArity(args, 1, 2);
+    auto size = GetIndex(args[0]);
+    if (size < 0) {
+        throw RuntimeError{"Negative vector size"};
+    }
+    if (static_cast<uint64_t>(size) > Heap::kMaxVectorSize) {
+        throw RuntimeError{"Vector size is too large"};
+    }
+    return heap->MakeVector(size, args.size() > 1 ? args[1] : Value::MakeFixnum(0));
+}
+
+Value VectorOf(Heap* heap, Args args) {
+    auto* vector = heap->MakeVector(args.size(), Value{});
+    std::copy(args.begin(), args.end(), vector->Elements());
+    return vector;
+}
+
+Value VectorLength(Heap*, Args args) {
+    CheckArity(args, 1);
+    return Value::MakeFixnum(GetVector(args[0])->size);
+}
+
+Value& VectorElement(Vector* vector, Value index_value) {
+    auto index = GetIndex(index_value);
+    if (index < 0 || static_cast<size_t>(index) >= vector->size) {
+        throw RuntimeError{"Vector index out of range"};
+    }
+    return vector->Elements()[index];
+}
+
+Value VectorRef(Heap*, Args args) {
+    CheckArity(args, 2);
+    return VectorElement(GetVector(args[0]), args[1]);
+}
+
+Value VectorSet(Heap* heap, Args args) {
+    CheckArity(args, 3);
+    auto* vector = GetVector(args[0]);
+    CheckMutable(vector);
+    heap->WriteBarrier(args[2]);
+    VectorElement(vector, args[1]) = args[2];
+    return {};
+}
+
+Value MakeHashTable(Heap* heap, Args args) {
+    CheckArity(args, 0);
+    return heap->Make<HashTable>();
+}
+
+// (hash-ref table key [default]): без значения по умолчанию отсутствующий ключ - ошибка.
+Value HashRef(Heap*, Args args) {
+    CheckArity(args, 2, 3);
+    if (const auto* value = GetHashTable(args[0])->Find(GetKey(args[1]))) {
+        return *value;
+    }
+    if (args.size() == 3) {
+        return args[2];
+    }
+    throw RuntimeError{"Key not found: " + ToString(args[1])};
+}
+
+Value HashSet(Heap* heap, Args args) {
+    CheckArity(args, 3);
+    auto* table = GetHashTable(args[0]);
+    CheckMutable(table);
+    heap->WriteBarrier(args[2]);
+    table->Insert(heap, GetKey(args[1]), args[2]);
+    return {};
+}
+
+Value HashCount(Heap*, Args args) {
+    CheckArity(args, 1);
+    return Value::MakeFixnum(GetHashTable(args[0])->size);
+}
+
+int64_t ToMicroseconds(std::chrono::nanoseconds time) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time).count();
+}
+
+// Список (имя вызовы общее-время-мкс собственное-время-мкс байты места-вызова) по убыванию
+// собственного времени, где места-вызова - список (вызывающая-функция вызовы байты);
+// () если профилирование выключено.
+Value ProfileReport(Heap* heap, Args args) {
+    CheckArity(args, 0);
+    auto* profiler = heap->GetProfiler();
+    if (!profiler) {
+        return {};
+    }
+    auto report = profiler->GetReport();
+    Value result;
+    for (auto it = report.rbegin(); it != report.rend(); ++it) {
+        Value callers;
+        for (auto site = it->callers.rbegin(); site != it->callers.rend(); ++site) {
+            Value site_row[] = {
+                Value::MakeSymbol(SymbolTable::Instance().Intern(site->caller)),
+                MakeInteger(heap, static_cast<int64_t>(site->calls)),
+                MakeInteger(heap, static_cast<int64_t>(site->bytes_allocated)),
+            };
+            callers = heap->MakePair(List(heap, site_row), callers);
+        }
+        Value row[] = {
+            Value::MakeSymbol(SymbolTable::Instance().Intern(it->name)),
+            MakeInteger(heap, static_cast<int64_t>(it->calls)),
+            MakeInteger(heap, ToMicroseconds(it->inclusive_time)),
+            MakeInteger(heap, ToMicroseconds(it->exclusive_time)),
+            MakeInteger(heap, static_cast<int64_t>(it->bytes_allocated)),
+            callers,
+        };
+        result = heap->MakePair(List(heap, row), result);
+    }
+    return result;
+}
+
+struct BuiltinInfo {
+    const char* name;
+    BuiltinFunction function;
+};
+
+const BuiltinInfo kBuiltins[] = {
+    {"number?", [](Heap*, Args args) { return TypePredicate(args, IsNumber); }},
+    {"boolean?", [](Heap*, Args args) { return TypePredicate(args, &Value::IsBool); }},
+    {"symbol?", [](Heap*, Args args) { return TypePredicate(args, &Value::IsSymbol); }},
+    {"pair?", [](Heap*, Args args) { return TypePredicate(args, IsA<Pair>); }},
+    {"null?", [](Heap*, Args args) { return TypePredicate(args, &Value::IsNil); }},
+    {"list?", [](Heap*, Args args) { return TypePredicate(args, IsList); }},
+    {"procedure?", [](Heap*, Args args) { return TypePredicate(args, IsProcedure); }},
+    {"vector?", [](Heap*, Args args) { return TypePredicate(args, IsA<Vector>); }},
+    {"hash-table?", [](Heap*, Args args) { return TypePredicate(args, IsA<HashTable>); }},
+
+    {"=", Comparison<std::equal_to<int>>},
+    {"<", Comparison<std::less<int>>},
+    {">", Comparison<std::greater<int>>},
+    {"<=", Comparison<std::less_equal<int>>},
+    {">=", Comparison<std::greater_equal<int>>},
+
+    {"+", [](Heap* heap, Args args) { return Fold<Add>(heap, args, Value::MakeFixnum(0)); }},
+    {"*", [](Heap* heap, Args args) { return Fold<Multiply>(heap, args, Value::MakeFixnum(1)); }},
+    {"-", FoldFirst<Subtract>},
+    {"/", FoldFirst<Divide>},
+    {"max", FoldFirst<Max>},
+    {"min", FoldFirst<Min>},
+    {"abs", Abs},
+
+    {"not", Not},
+
+    {"cons", Cons},
+    {"car", Car},
+    {"cdr", Cdr},
+    {"set-car!", SetCar},
+    {"set-cdr!", SetCdr},
+    {"list", List},
+    {"list-ref", ListRef},
+    {"list-tail", ListTail},
+
+    {"make-vector", MakeVector},
+    {"vector", VectorOf},
+    {"vector-length", VectorLength},
+    {"vector-ref", VectorRef},
+    {"vector-set!", VectorSet},
+
+    {"make-hash-table", MakeHashTable},
+    {"hash-ref", HashRef},
+    {"hash-set!", HashSet},
+    {"hash-count", HashCount},
+
+    {"profile-report", ProfileReport},
+};
+
+}  // namespace
+
+void RegisterBuiltins(Heap* heap, Globals* globals) {
+    for (const auto& [name, function] : kBuiltins) {
+        globals->DefineBuiltin(name, heap->Make<Builtin>(name, function));
+    }
+}
+
+Builtin* MakeBuiltin(Heap* heap, std::string_view name) {
+    for (const auto& info : kBuiltins) {
+        if (info.name == name) {
+            return heap->Make<Builtin>(info.name, info.function);
+        }
+    }
+    return nullptr;
+}
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <heap.h>
+#include <globals.h>
+#include <procedure.h>
+
+#include <string_view>
+
+void RegisterBuiltins(Heap* heap, Globals* globals);
+
+// Новый объект для встроенной функции с таким именем; nullptr, если такой нет.
+Builtin* MakeBuiltin(Heap* heap, std::string_view name);
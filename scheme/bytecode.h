@@ -0,0 +1,71 @@
+#pragma once
+
+#include <value.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Каждое выражение компилируется в код, оставляющий на стеке ровно одно значение.
+enum class OpCode : uint8_t {
+    kConst,          // push constants[index]
+    kLoadLocal,      // push переменную из кадра на глубине count, слот index
+    kStoreLocal,     // кадр(count)[index] = top, top = ()
+    kLoadGlobal,     // push globals[index], NameError если не определена
+    kStoreGlobal,    // set!: globals[index] = top, top = (), NameError если не определена
+    kDefineGlobal,   // globals[index] = top, top = ()
+    kPop,            // выбросить вершину стека
+    kJump,           // pc = index
+    kJumpIfFalse,    // pop, если #f то pc = index
+    kJumpIfFalseOrPop,  // если top == #f то pc = index, иначе pop
+    kJumpIfTrueOrPop,   // если top != #f то pc = index, иначе pop
+    kMakeClosure,    // push замыкание над children[index] и текущим кадром
+    kCall,           // вызов с count аргументами, функция лежит под ними
+    kTailCall,       // kCall в хвостовой позиции: кадр замыкания заменяет текущий
+    kReturn,         // вернуть top из текущей функции
+    kIllFormed,      // SyntaxError, отложенная до выполнения (например, (f . x))
+
+    // Встроенные примитивы, которые компилятор подставляет вместо вызова.
+    // count - число аргументов на стеке, index - глобальный слот с исходной функцией:
+    // если его переопределили, выполняется обычный вызов.
+    kAdd,
+    kSub,
+    kMul,
+    kDiv,
+    kNumEqual,
+    kLess,
+    kGreater,
+    kLessEqual,
+    kGreaterEqual,
+    kNot,
+    kIsNull,
+    kIsPair,
+    kCons,
+    kCar,
+    kCdr,
+};
+
+struct Instruction {
+    OpCode op;
+    uint16_t count = 0;
+    uint32_t index = 0;
+};
+
+// Скомпилированная функция. Живёт в куче, пока на неё ссылаются замыкания или стек вызовов.
+struct Code : HeapObject {
+    static constexpr auto kType = ObjectType::kCode;
+
+    Code() : HeapObject{kType} {
+    }
+
+    std::vector<Instruction> instructions;
+    std::vector<Value> constants;
+    std::vector<Code*> children;
+
+    std::string name;
+    size_t param_count = 0;
+    bool variadic = false;
+    // Параметры и внутренние define, кадр выделяется сразу нужного размера.
+    size_t slot_count = 0;
+};
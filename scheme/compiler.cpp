@@ -0,0 +1,474 @@
+#include <compiler.h>
+#include <error.h>
+#include <numbers.h>
+#include <symbols.h>
+
+#include <algorithm>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+namespace {
+
+struct PrimitiveInfo {
+    std::string_view name;
+    OpCode op;
+    size_t min_args;
+    size_t max_args;
+};
+
+constexpr size_t kAnyCount = std::numeric_limits<uint16_t>::max();
+
+constexpr PrimitiveInfo kPrimitives[] = {
+    {"+", OpCode::kAdd, 0, kAnyCount},
+    {"-", OpCode::kSub, 1, kAnyCount},
+    {"*", OpCode::kMul, 0, kAnyCount},
+    {"/", OpCode::kDiv, 1, kAnyCount},
+    {"=", OpCode::kNumEqual, 0, kAnyCount},
+    {"<", OpCode::kLess, 0, kAnyCount},
+    {">", OpCode::kGreater, 0, kAnyCount},
+    {"<=", OpCode::kLessEqual, 0, kAnyCount},
+    {">=", OpCode::kGreaterEqual, 0, kAnyCount},
+    {"not", OpCode::kNot, 1, 1},
+    {"null?", OpCode::kIsNull, 1, 1},
+    {"pair?", OpCode::kIsPair, 1, 1},
+    {"cons", OpCode::kCons, 2, 2},
+    {"car", OpCode::kCar, 1, 1},
+    {"cdr", OpCode::kCdr, 1, 1},
+};
+
+std::optional<OpCode> FindPrimitive(uint32_t symbol, size_t argc) {
+    static const auto kBySymbol = [] {
+        std::unordered_map<uint32_t, const PrimitiveInfo*> result;
+        for (const auto& primitive : kPrimitives) {
+            result.emplace(SymbolTable::Instance().Intern(primitive.name), &primitive);
+        }
+        return result;
+    }();
+    auto it = kBySymbol.find(symbol);
+    if (it == kBySymbol.end()) {
+        return std::nullopt;
+    }
+    const auto& primitive = *it->second;
+    if (argc < primitive.min_args || argc > primitive.max_args) {
+        return std::nullopt;
+    }
+    return primitive.op;
+}
+
+// Элементы списка; false, если список не заканчивается на ().
+bool ToVector(const Node* list, std::vector<const Node*>* result) {
+    while (const auto* cell = As<CellNode>(list)) {
+        result->push_back(cell->first);
+        list = cell->second;
+    }
+    return !list;
+}
+
+std::optional<uint32_t> GetSymbol(const Node* obj) {
+    if (const auto* symbol = As<SymbolNode>(obj)) {
+        return symbol->id;
+    }
+    return std::nullopt;
+}
+
+const std::string& GetName(uint32_t symbol) {
+    return SymbolTable::Instance().GetName(symbol);
+}
+
+size_t Emit(Code* code, OpCode op, size_t count = 0, size_t index = 0) {
+    if (count > std::numeric_limits<uint16_t>::max() ||
+        index > std::numeric_limits<uint32_t>::max()) {
+        throw SyntaxError{"Expression is too large"};
+    }
+    code->instructions.push_back(
+        {op, static_cast<uint16_t>(count), static_cast<uint32_t>(index)});
+    return code->instructions.size() - 1;
+}
+
+// Направляет переход на следующую инструкцию.
+void PatchJump(Code* code, size_t jump) {
+    code->instructions[jump].index = code->instructions.size();
+}
+
+// Переход на kReturn сам становится kReturn, после чего вызов перед kReturn - хвостовой.
+// Так хвостовые вызовы находятся в ветках if, and, or и begin без отдельного флага
+// в каждом Compile*.
+void MarkTailCalls(Code* code) {
+    auto& instructions = code->instructions;
+    // Переходы только вперёд, поэтому цепочки переходов разворачиваются с конца.
+    for (auto it = instructions.rbegin(); it != instructions.rend(); ++it) {
+        if (it->op == OpCode::kJump && instructions[it->index].op == OpCode::kReturn) {
+            it->op = OpCode::kReturn;
+        }
+    }
+    for (size_t i = 0; i + 1 < instructions.size(); ++i) {
+        if (instructions[i].op == OpCode::kCall && instructions[i + 1].op == OpCode::kReturn) {
+            instructions[i].op = OpCode::kTailCall;
+        }
+    }
+}
+
+}  // namespace
+
+struct Compiler::Scope {
+    Scope* parent;
+    std::vector<uint32_t> symbols;
+
+    std::optional<size_t> Find(uint32_t symbol) const {
+        auto it = std::find(symbols.begin(), symbols.end(), symbol);
+        if (it == symbols.end()) {
+            return std::nullopt;
+        }
+        return it - symbols.begin();
+    }
+
+    size_t Declare(uint32_t symbol) {
+        if (auto slot = Find(symbol)) {
+            return *slot;
+        }
+        symbols.push_back(symbol);
+        return symbols.size() - 1;
+    }
+
+    // Внутренние define тела видны во всём теле, поэтому слоты под них
+    // заводятся до компиляции.
+    void DeclareDefines(Args body) {
+        for (const auto& form : body) {
+            const auto* cell = As<CellNode>(form);
+            if (!cell) {
+                continue;
+            }
+            auto head = GetSymbol(cell->first);
+            const auto* rest = As<CellNode>(cell->second);
+            if (!head || !rest) {
+                continue;
+            }
+            if (*head == symbol_id::kBegin) {
+                std::vector<const Node*> forms;
+                ToVector(cell->second, &forms);
+                DeclareDefines(forms);
+            } else if (*head == symbol_id::kDefine) {
+                auto target = rest->first;
+                if (const auto* signature = As<CellNode>(target)) {
+                    target = signature->first;
+                }
+                if (auto symbol = GetSymbol(target)) {
+                    Declare(*symbol);
+                }
+            }
+        }
+    }
+};
+
+Compiler::Compiler(Heap* heap, Globals* globals) : heap_{heap}, globals_{globals} {
+}
+
+Code* Compiler::Compile(const Node* expression) {
+    auto* code = heap_->Make<Code>();
+    CompileExpression(expression, code, nullptr);
+    Emit(code, OpCode::kReturn);
+    MarkTailCalls(code);
+    return code;
+}
+
+void Compiler::CompileExpression(const Node* expression, Code* code,
+                                 Scope* scope) {
+    if (auto symbol = GetSymbol(expression)) {
+        CompileVariable(*symbol, code, scope);
+    } else if (const auto* cell = As<CellNode>(expression)) {
+        CompileApplication(*cell, code, scope);
+    } else if (!expression) {
+        // () не вычисляется сам в себя: это вызов без функции.
+        EmitConstant(code, Value{});
+        Emit(code, OpCode::kCall, 0);
+    } else {
+        EmitConstant(code, ToValue(expression));
+    }
+}
+
+void Compiler::CompileVariable(uint32_t symbol, Code* code, Scope* scope) {
+    size_t depth = 0;
+    for (auto* current = scope; current; current = current->parent, ++depth) {
+        if (auto slot = current->Find(symbol)) {
+            Emit(code, OpCode::kLoadLocal, depth, *slot);
+            return;
+        }
+    }
+    Emit(code, OpCode::kLoadGlobal, 0, globals_->Resolve(symbol));
+}
+
+void Compiler::CompileApplication(const CellNode& form, Code* code, Scope* scope) {
+    std::vector<const Node*> args;
+    bool is_proper = ToVector(form.second, &args);
+
+    auto symbol = GetSymbol(form.first);
+    if (symbol) {
+        if (auto special_form = FindSpecialForm(*symbol)) {
+            if (!is_proper) {
+                throw SyntaxError{"Ill-formed special form: " + GetName(*symbol)};
+            }
+            (this->*special_form)(args, code, scope);
+            return;
+        }
+    }
+
+    if (!is_proper) {
+        Emit(code, OpCode::kIllFormed);
+        return;
+    }
+
+    bool is_local = false;
+    for (auto* current = scope; symbol && current; current = current->parent) {
+        is_local = is_local || current->Find(*symbol);
+    }
+    if (symbol && !is_local) {
+        if (auto op = FindPrimitive(*symbol, args.size())) {
+            for (const auto& arg : args) {
+                CompileExpression(arg, code, scope);
+            }
+            Emit(code, *op, args.size(), globals_->Resolve(*symbol));
+            return;
+        }
+    }
+
+    CompileExpression(form.first, code, scope);
+    for (const auto& arg : args) {
+        CompileExpression(arg, code, scope);
+    }
+    Emit(code, OpCode::kCall, args.size());
+}
+
+void Compiler::CompileBody(Args body, Code* code, Scope* scope) {
+    if (body.empty()) {
+        EmitConstant(code, Value{});
+    }
+    for (size_t i = 0; i < body.size(); ++i) {
+        if (i > 0) {
+            Emit(code, OpCode::kPop);
+        }
+        CompileExpression(body[i], code, scope);
+    }
+}
+
+void Compiler::CompileFunction(std::string name, const Node* params,
+                               Args body, Code* code, Scope* scope) {
+    if (body.empty()) {
+        throw SyntaxError{"Lambda without body"};
+    }
+
+    auto* function = heap_->Make<Code>();
+    function->name = std::move(name);
+    Scope inner{scope, {}};
+
+    auto rest = params;
+    while (const auto* cell = As<CellNode>(rest)) {
+        auto param = GetSymbol(cell->first);
+        if (!param || inner.Find(*param)) {
+            throw SyntaxError{"Bad lambda parameter"};
+        }
+        inner.symbols.push_back(*param);
+        rest = cell->second;
+    }
+    function->param_count = inner.symbols.size();
+    if (rest) {
+        auto param = GetSymbol(rest);
+        if (!param || inner.Find(*param)) {
+            throw SyntaxError{"Bad lambda parameter"};
+        }
+        inner.symbols.push_back(*param);
+        function->variadic = true;
+    }
+
+    inner.DeclareDefines(body);
+    CompileBody(body, function, &inner);
+    Emit(function, OpCode::kReturn);
+    MarkTailCalls(function);
+    function->slot_count = inner.symbols.size();
+
+    code->children.push_back(function);
+    Emit(code, OpCode::kMakeClosure, 0, code->children.size() - 1);
+}
+
+void Compiler::CompileStore(uint32_t symbol, bool define, Code* code, Scope* scope) {
+    if (define) {
+        if (scope) {
+            Emit(code, OpCode::kStoreLocal, 0, scope->Declare(symbol));
+        } else {
+            Emit(code, OpCode::kDefineGlobal, 0, globals_->Resolve(symbol));
+        }
+        return;
+    }
+
+    size_t depth = 0;
+    for (auto* current = scope; current; current = current->parent, ++depth) {
+        if (auto slot = current->Find(symbol)) {
+            Emit(code, OpCode::kStoreLocal, depth, *slot);
+            return;
+        }
+    }
+    Emit(code, OpCode::kStoreGlobal, 0, globals_->Resolve(symbol));
+}
+
+void Compiler::CompileQuote(Args args, Code* code, Scope*) {
+    if (args.size() != 1) {
+        throw SyntaxError{"quote expects exactly one argument"};
+    }
+    EmitConstant(code, ToValue(args[0]));
+}
+
+void Compiler::CompileIf(Args args, Code* code, Scope* scope) {
+    if (args.size() != 2 && args.size() != 3) {
+        throw SyntaxError{"if expects condition and one or two branches"};
+    }
+    CompileExpression(args[0], code, scope);
+    auto to_else = Emit(code, OpCode::kJumpIfFalse);
+    CompileExpression(args[1], code, scope);
+    auto to_end = Emit(code, OpCode::kJump);
+    PatchJump(code, to_else);
+    if (args.size() == 3) {
+        CompileExpression(args[2], code, scope);
+    } else {
+        EmitConstant(code, Value{});
+    }
+    PatchJump(code, to_end);
+}
+
+void Compiler::CompileDefine(Args args, Code* code, Scope* scope) {
+    if (args.empty()) {
+        throw SyntaxError{"define expects a name"};
+    }
+    if (auto symbol = GetSymbol(args[0])) {
+        if (args.size() != 2) {
+            throw SyntaxError{"define expects a name and a value"};
+        }
+        if (scope) {
+            scope->Declare(*symbol);
+        }
+        CompileExpression(args[1], code, scope);
+        CompileStore(*symbol, true, code, scope);
+    } else if (const auto* signature = As<CellNode>(args[0])) {
+        auto symbol = GetSymbol(signature->first);
+        if (!symbol) {
+            throw SyntaxError{"define expects a function name"};
+        }
+        if (scope) {
+            scope->Declare(*symbol);
+        }
+        CompileFunction(GetName(*symbol), signature->second, args.subspan(1), code, scope);
+        CompileStore(*symbol, true, code, scope);
+    } else {
+        throw SyntaxError{"define expects a name"};
+    }
+}
+
+void Compiler::CompileSet(Args args, Code* code, Scope* scope) {
+    auto symbol = args.size() == 2 ? GetSymbol(args[0]) : std::nullopt;
+    if (!symbol) {
+        throw SyntaxError{"set! expects a name and a value"};
+    }
+    CompileExpression(args[1], code, scope);
+    CompileStore(*symbol, false, code, scope);
+}
+
+void Compiler::CompileLambda(Args args, Code* code, Scope* scope) {
+    if (args.empty()) {
+        throw SyntaxError{"lambda expects parameters and body"};
+    }
+    CompileFunction("lambda", args[0], args.subspan(1), code, scope);
+}
+
+void Compiler::CompileBegin(Args args, Code* code, Scope* scope) {
+    CompileBody(args, code, scope);
+}
+
+void Compiler::CompileAnd(Args args, Code* code, Scope* scope) {
+    if (args.empty()) {
+        EmitConstant(code, Value::MakeBool(true));
+        return;
+    }
+    std::vector<size_t> jumps;
+    for (size_t i = 0; i < args.size(); ++i) {
+        CompileExpression(args[i], code, scope);
+        if (i + 1 < args.size()) {
+            jumps.push_back(Emit(code, OpCode::kJumpIfFalseOrPop));
+        }
+    }
+    for (auto jump : jumps) {
+        PatchJump(code, jump);
+    }
+}
+
+void Compiler::CompileOr(Args args, Code* code, Scope* scope) {
+    if (args.empty()) {
+        EmitConstant(code, Value::MakeBool(false));
+        return;
+    }
+    std::vector<size_t> jumps;
+    for (size_t i = 0; i < args.size(); ++i) {
+        CompileExpression(args[i], code, scope);
+        if (i + 1 < args.size()) {
+            jumps.push_back(Emit(code, OpCode::kJumpIfTrueOrPop));
+        }
+    }
+    for (auto jump : jumps) {
+        PatchJump(code, jump);
+    }
+}
+
+void Compiler::EmitConstant(Code* code, Value value) {
+    code->constants.push_back(value);
+    Emit(code, OpCode::kConst, 0, code->constants.size() - 1);
+}
+
+// Константы из AST копируются в кучу. Сборка во время компиляции не запускается,
+// так что промежуточные значения не нужно никуда регистрировать.
+Value Compiler::ToValue(const Node* value) {
+    if (const auto* number = As<NumberNode>(value)) {
+        return MakeInteger(heap_, number->value);
+    } else if (const auto* bignum = As<BignumNode>(value)) {
+        return NumberFromString(heap_, bignum->digits);
+    } else if (const auto* symbol = As<SymbolNode>(value)) {
+        return Value::MakeSymbol(symbol->id);
+    } else if (const auto* boolean = As<BooleanNode>(value)) {
+        return Value::MakeBool(boolean->value);
+    } else if (As<CellNode>(value)) {
+        std::vector<Value> elements;
+        auto tail = value;
+        while (const auto* current = As<CellNode>(tail)) {
+            elements.push_back(ToValue(current->first));
+            tail = current->second;
+        }
+        auto result = ToValue(tail);
+        for (auto it = elements.rbegin(); it != elements.rend(); ++it) {
+            result = heap_->MakePair(*it, result);
+        }
+        return result;
+    }
+    return {};
+}
+
+Compiler::SpecialForm Compiler::FindSpecialForm(uint32_t symbol) {
+    switch (symbol) {
+        case symbol_id::kQuote:
+            return &Compiler::CompileQuote;
+        case symbol_id::kIf:
+            return &Compiler::CompileIf;
+        case symbol_id::kDefine:
+            return &Compiler::CompileDefine;
+        case symbol_id::kSet:
+            return &Compiler::CompileSet;
+        case symbol_id::kLambda:
+            return &Compiler::CompileLambda;
+        case symbol_id::kBegin:
+            return &Compiler::CompileBegin;
+        case symbol_id::kAnd:
+            return &Compiler::CompileAnd;
+        case symbol_id::kOr:
+            return &Compiler::CompileOr;
+        default:
+            return nullptr;
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <ast.h>
+#include <bytecode.h>
+#include <globals.h>
+#include <heap.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// Переводит AST в байткод. Локальные переменные разрешаются в пары (глубина кадра, слот),
+// глобальные - в индекс слота в Globals, вызовы встроенных арифметики и операций над
+// парами подставляются как отдельные инструкции.
+class Compiler {
+public:
+    Compiler(Heap* heap, Globals* globals);
+
+    // Выражение верхнего уровня компилируется в функцию без параметров. Результат ни на что
+    // не ссылается, поэтому его нужно выполнить до следующей сборки мусора.
+    Code* Compile(const Node* expression);
+
+private:
+    struct Scope;
+    using Args = std::span<const Node* const>;
+    using SpecialForm = void (Compiler::*)(Args, Code*, Scope*);
+
+    void CompileExpression(const Node* expression, Code* code, Scope* scope);
+    void CompileVariable(uint32_t symbol, Code* code, Scope* scope);
+    void CompileApplication(const CellNode& form, Code* code, Scope* scope);
+    void CompileBody(Args body, Code* code, Scope* scope);
+    void CompileFunction(std::string name, const Node* params, Args body,
+                         Code* code, Scope* scope);
+    void CompileStore(uint32_t symbol, bool define, Code* code, Scope* scope);
+
+    void CompileQuote(Args args, Code* code, Scope* scope);
+    void CompileIf(Args args, Code* code, Scope* scope);
+    void CompileDefine(Args args, Code* code, Scope* scope);
+    void CompileSet(Args args, Code* code, Scope* scope);
+    void CompileLambda(Args args, Code* code, Scope* scope);
+    void CompileBegin(Args args, Code* code, Scope* scope);
+    void CompileAnd(Args args, Code* code, Scope* scope);
+    void CompileOr(Args args, Code* code, Scope* scope);
+
+    void EmitConstant(Code* code, Value value);
+    Value ToValue(const Node* value);
+
+    static SpecialForm FindSpecialForm(uint32_t symbol);
+
+    Heap* heap_;
+    Globals* globals_;
+};
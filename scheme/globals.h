@@ -0,0 +1,105 @@
+#pragma once
+
+#include <value.h>
+#include <heap.h>
+#include <error.h>
+#include <symbols.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Глобальные переменные. Слот глобальной переменной - номер ее символа в SymbolTable,
+// так что компилятору достаточно убедиться, что вектор слотов достаточно длинный,
+// а коду - обратиться к слоту по индексу. Слот может существовать до define,
+// тогда чтение из него - NameError.
+class Globals : public RootSet {
+public:
+    explicit Globals(Heap* heap) : heap_{heap} {
+        heap_->AddRootSet(this);
+    }
+
+    // Копия таблицы base: значения общие, но дальнейшие define и set! видны только здесь.
+    Globals(Heap* heap, const Globals& base) : heap_{heap}, entries_{base.entries_} {
+        heap_->AddRootSet(this);
+    }
+
+    ~Globals() {
+        heap_->RemoveRootSet(this);
+    }
+
+    Globals(const Globals&) = delete;
+    Globals& operator=(const Globals&) = delete;
+
+    size_t Resolve(uint32_t symbol) {
+        if (symbol >= entries_.size()) {
+            entries_.resize(symbol + 1);
+        }
+        return symbol;
+    }
+
+    Value Get(size_t index) const {
+        const auto& entry = entries_[index];
+        if (!entry.defined) {
+            throw NameError{GetName(index)};
+        }
+        return entry.value;
+    }
+
+    void Set(size_t index, Value value) {
+        auto& entry = entries_[index];
+        if (!entry.defined) {
+            throw NameError{GetName(index)};
+        }
+        entry.value = value;
+        entry.builtin = false;
+    }
+
+    void Define(size_t index, Value value) {
+        auto& entry = entries_[index];
+        entry.value = value;
+        entry.defined = true;
+        entry.builtin = false;
+    }
+
+    void DefineBuiltin(std::string_view name, Value value) {
+        auto index = Resolve(SymbolTable::Instance().Intern(name));
+        Define(index, value);
+        entries_[index].builtin = true;
+    }
+
+    size_t GetSlotCount() const {
+        return entries_.size();
+    }
+
+    bool IsDefined(size_t index) const {
+        return entries_[index].defined;
+    }
+
+    // Слот всё ещё содержит встроенную функцию, с которой интерпретатор стартовал.
+    bool IsBuiltin(size_t index) const {
+        return entries_[index].builtin;
+    }
+
+    const std::string& GetName(size_t index) const {
+        return SymbolTable::Instance().GetName(index);
+    }
+
+    void TraceRoots(Heap* heap) override {
+        for (const auto& entry : entries_) {
+            heap->Mark(entry.value);
+        }
+    }
+
+private:
+    struct Entry {
+        Value value;
+        bool defined = false;
+        bool builtin = false;
+    };
+
+    Heap* heap_;
+    std::vector<Entry> entries_;
+};
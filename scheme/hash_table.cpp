@@ -0,0 +1,59 @@
+#include <hash_table.h>
+#include <heap.h>
+
+#include <cstdint>
+
+namespace {
+
+constexpr size_t kInitialCapacity = 8;
+
+size_t Hash(Value key) {
+    auto bits = key.IsFixnum() ? static_cast<uint64_t>(key.GetFixnum()) << 1
+                               : (uint64_t{key.GetSymbol()} << 1) | 1;
+    bits *= 0x9e3779b97f4a7c15;
+    return bits ^ (bits >> 32);
+}
+
+HashTable::Entry* FindSlot(std::vector<HashTable::Entry>* entries, Value key) {
+    auto mask = entries->size() - 1;
+    for (auto i = Hash(key) & mask;; i = (i + 1) & mask) {
+        auto& entry = (*entries)[i];
+        if (entry.key == key || entry.key.IsNil()) {
+            return &entry;
+        }
+    }
+}
+
+}  // namespace
+
+bool HashTable::IsValidKey(Value key) {
+    return key.IsFixnum() || key.IsSymbol();
+}
+
+Value* HashTable::Find(Value key) {
+    if (entries.empty()) {
+        return nullptr;
+    }
+    auto* entry = FindSlot(&entries, key);
+    return entry->key.IsNil() ? nullptr : &entry->value;
+}
+
+void HashTable::Insert(Heap* heap, Value key, Value value) {
+    if ((size + 1) * 4 > entries.size() * 3) {
+        std::vector<Entry> grown(entries.empty() ? kInitialCapacity : entries.size() * 2);
+        for (const auto& entry : entries) {
+            if (!entry.key.IsNil()) {
+                *FindSlot(&grown, entry.key) = entry;
+            }
+        }
+        auto old_bytes = GetExternalBytes();
+        entries.swap(grown);
+        heap->OnExternalResize(old_bytes, GetExternalBytes());
+    }
+    auto* entry = FindSlot(&entries, key);
+    if (entry->key.IsNil()) {
+        entry->key = key;
+        ++size;
+    }
+    entry->value = value;
+}
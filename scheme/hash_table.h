@@ -0,0 +1,38 @@
+#pragma once
+
+#include <value.h>
+
+#include <cstddef>
+#include <vector>
+
+class Heap;
+
+// Хеш-таблица с открытой адресацией и линейным пробированием. Ключи - fixnum и символы,
+// то есть непосредственные значения: ключи равны, когда равны их слова, а пустой список,
+// который ключом быть не может, отмечает свободную ячейку.
+struct HashTable : HeapObject {
+    static constexpr auto kType = ObjectType::kHashTable;
+
+    struct Entry {
+        Value key;
+        Value value;
+    };
+
+    HashTable() : HeapObject{kType} {
+    }
+
+    static bool IsValidKey(Value key);
+
+    // nullptr, если ключа нет.
+    Value* Find(Value key);
+    // Ячейки лежат вне кучи, поэтому при росте таблицы их память учитывается в heap.
+    void Insert(Heap* heap, Value key, Value value);
+
+    size_t GetExternalBytes() const {
+        return entries.capacity() * sizeof(Entry);
+    }
+
+    size_t size = 0;
+    // Размер - степень двойки, заполнено не больше трех четвертей.
+    std::vector<Entry> entries;
+};
@@ -0,0 +1,430 @@
+#include <heap.h>
+#include <bytecode.h>
+#include <error.h>
+#include <hash_table.h>
+#include <procedure.h>
+
+#include <algorithm>
+#include <bit>
+#include <limits>
+#include <new>
+
+template <class Function>
+void Heap::ForEachObject(Function function) {
+    for (size_t i = 0; i < kSizeClasses.size(); ++i) {
+        auto size = kSizeClasses[i];
+        for (const auto& arena : size_classes_[i].arenas) {
+            for (size_t offset = 0; offset + size <= arena.size; offset += size) {
+                auto* object = reinterpret_cast<HeapObject*>(arena.memory.get() + offset);
+                if (object->type != ObjectType::kFree) {
+                    function(object);
+                }
+            }
+        }
+    }
+    for (auto [object, size] : large_objects_) {
+        function(object);
+    }
+}
+
+Heap::~Heap() {
+    ForEachObject([this](HeapObject* object) { Destroy(object); });
+    for (auto [object, size] : large_objects_) {
+        ::operator delete(object);
+    }
+}
+
+Environment* Heap::MakeEnvironment(Environment* parent, size_t size) {
+    auto* memory = Allocate(sizeof(Environment) + size * sizeof(Value));
+    return OnCreate(new (memory) Environment(parent, size));
+}
+
+Bignum* Heap::MakeBignum(bool negative, size_t size) {
+    auto* memory = Allocate(sizeof(Bignum) + size * sizeof(uint32_t));
+    return OnCreate(new (memory) Bignum(negative, size));
+}
+
+Vector* Heap::MakeVector(size_t size, Value fill) {
+    if (size > kMaxVectorSize) {
+        throw RuntimeError{"Vector is too large"};
+    }
+    auto* memory = Allocate(sizeof(Vector) + size * sizeof(Value));
+    return OnCreate(new (memory) Vector(size, fill));
+}
+
+Value Heap::MakePair(Value first, Value second) {
+    return Make<Pair>(first, second);
+}
+
+void Heap::AddRootSet(RootSet* roots) {
+    root_sets_.push_back(roots);
+}
+
+void Heap::RemoveRootSet(RootSet* roots) {
+    std::erase(root_sets_, roots);
+}
+
+void Heap::Mark(Value value) {
+    auto* object = value.GetObject();
+    if (object && !object->marked) {
+        object->marked = true;
+        mark_stack_.push_back(object);
+    }
+}
+
+void Heap::Collect() {
+    auto start = std::chrono::steady_clock::now();
+
+    // Начатый инкрементальный цикл доводится до конца, а потом делается свежий, иначе
+    // отмеченные в нем объекты, которые с тех пор стали мусором, пережили бы сборку.
+    if (phase_ == Phase::kMarking) {
+        TraceRoots();
+        Drain(std::numeric_limits<size_t>::max());
+        Sweep();
+        phase_ = Phase::kIdle;
+        ++stats_.collections;
+    } else if (phase_ == Phase::kSweeping) {
+        SweepStep(std::numeric_limits<size_t>::max());
+        FinishSweep();
+    }
+    TraceRoots();
+    Drain(std::numeric_limits<size_t>::max());
+    Sweep();
+    phase_ = Phase::kIdle;
+    ++stats_.collections;
+
+    RecordPause(std::chrono::steady_clock::now() - start);
+    allocated_since_collection_ = 0;
+}
+
+void Heap::CollectStep() {
+    if (!incremental_) {
+        Collect();
+        return;
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    // Если между безопасными точками выделено много (например, компилятором), шаг делает
+    // соразмерно больше работы, иначе сборка не догонит программу.
+    auto budget = std::max(increment_budget_, allocated_since_collection_ / kBytesPerWorkUnit);
+    switch (phase_) {
+        case Phase::kIdle:
+            TraceRoots();
+            phase_ = Phase::kMarking;
+            rescans_ = 0;
+            break;
+        case Phase::kMarking:
+            Drain(budget);
+            if (!mark_stack_.empty()) {
+                break;
+            }
+            // Записи в корни идут мимо барьера, поэтому, когда серых объектов не осталось,
+            // корни просматриваются еще раз. Разметка закончена, если это ничего не добавило.
+            // Программа может каждый раз успевать создать новые объекты, поэтому после
+            // нескольких попыток разметка доводится до конца за один шаг.
+            TraceRoots();
+            if (++rescans_ >= kMaxRescans) {
+                Drain(std::numeric_limits<size_t>::max());
+            }
+            if (mark_stack_.empty()) {
+                SweepLargeObjects();
+                phase_ = Phase::kSweeping;
+                sweep_class_ = 0;
+                sweep_arena_ = 0;
+            }
+            break;
+        case Phase::kSweeping:
+            if (SweepStep(budget)) {
+                FinishSweep();
+            }
+            break;
+    }
+
+    RecordPause(std::chrono::steady_clock::now() - start);
+    allocated_since_collection_ = 0;
+}
+
+void Heap::Freeze() {
+    Collect();
+    ForEachObject([](HeapObject* object) {
+        object->marked = true;
+        object->frozen = true;
+    });
+}
+
+void Heap::SetCollectionThreshold(size_t bytes) {
+    threshold_ = bytes;
+}
+
+void Heap::SetIncremental(bool incremental) {
+    incremental_ = incremental;
+}
+
+void Heap::SetIncrementBudget(size_t budget) {
+    increment_budget_ = std::max<size_t>(budget, 1);
+    increment_interval_ = increment_budget_ * kBytesPerWorkUnit;
+}
+
+const GcStats& Heap::GetStats() const {
+    return stats_;
+}
+
+void Heap::SetProfiler(Profiler* profiler) {
+    profiler_ = profiler;
+}
+
+Profiler* Heap::GetProfiler() const {
+    return profiler_;
+}
+
+void* Heap::Allocate(size_t size) {
+    auto it = std::lower_bound(kSizeClasses.begin(), kSizeClasses.end(), size);
+    if (it == kSizeClasses.end()) {
+        auto* object = static_cast<HeapObject*>(::operator new(size, std::nothrow));
+        if (!object) {
+            throw RuntimeError{"Out of memory"};
+        }
+        large_objects_.push_back({object, size});
+        OnAllocate(size);
+        return object;
+    }
+
+    auto size_class = static_cast<uint8_t>(it - kSizeClasses.begin());
+    auto& free_list = size_classes_[size_class].free_list;
+    if (!free_list) {
+        AddArena(size_class);
+    }
+    auto* slot = free_list;
+    free_list = slot->next;
+
+    OnAllocate(*it);
+    return slot;
+}
+
+void Heap::OnAllocate(size_t size) {
+    ++stats_.allocations;
+    stats_.bytes_allocated += size;
+    stats_.live_bytes += size;
+    allocated_since_collection_ += size;
+    if (profiler_) {
+        profiler_->OnAllocate(size);
+    }
+}
+
+void Heap::OnExternalResize(size_t old_bytes, size_t new_bytes) {
+    stats_.bytes_allocated += new_bytes;
+    stats_.bytes_freed += old_bytes;
+    stats_.live_bytes += new_bytes - old_bytes;
+    allocated_since_collection_ += new_bytes;
+}
+
+void Heap::AddArena(uint8_t size_class) {
+    auto size = kSizeClasses[size_class];
+    auto& arenas = size_classes_[size_class].arenas;
+    auto arena_size = arenas.empty() ? kMinArenaSize
+                                     : std::min(2 * arenas.back().size, kMaxArenaSize);
+    auto* memory = new std::byte[arena_size];
+    arenas.push_back({std::unique_ptr<std::byte[]>{memory}, arena_size});
+    auto& free_list = size_classes_[size_class].free_list;
+    for (auto offset = arena_size / size * size; offset >= size; offset -= size) {
+        free_list =
+            new (memory + offset - size) FreeSlot{HeapObject{ObjectType::kFree}, free_list};
+    }
+}
+
+void Heap::TraceRoots() {
+    for (auto* roots : root_sets_) {
+        roots->TraceRoots(this);
+    }
+}
+
+// Просматривает не больше budget серых объектов, возвращает, сколько просмотрено.
+size_t Heap::Drain(size_t budget) {
+    size_t work = 0;
+    for (; work < budget && !mark_stack_.empty(); ++work) {
+        auto* object = mark_stack_.back();
+        mark_stack_.pop_back();
+        TraceChildren(object);
+    }
+    return work;
+}
+
+void Heap::TraceChildren(HeapObject* object) {
+    switch (object->type) {
+        case ObjectType::kPair: {
+            auto* pair = static_cast<Pair*>(object);
+            Mark(pair->first);
+            Mark(pair->second);
+            break;
+        }
+        case ObjectType::kClosure: {
+            auto* closure = static_cast<Closure*>(object);
+            Mark(closure->code);
+            Mark(closure->env);
+            break;
+        }
+        case ObjectType::kEnvironment: {
+            auto* env = static_cast<Environment*>(object);
+            Mark(env->parent);
+            for (size_t i = 0; i < env->size; ++i) {
+                Mark(env->Slots()[i]);
+            }
+            break;
+        }
+        case ObjectType::kCode: {
+            auto* code = static_cast<Code*>(object);
+            for (auto constant : code->constants) {
+                Mark(constant);
+            }
+            for (auto* child : code->children) {
+                Mark(child);
+            }
+            break;
+        }
+        case ObjectType::kVector: {
+            auto* vector = static_cast<Vector*>(object);
+            for (size_t i = 0; i < vector->size; ++i) {
+                Mark(vector->Elements()[i]);
+            }
+            break;
+        }
+        case ObjectType::kHashTable:
+            // Ключи - непосредственные значения, их отмечать не нужно.
+            for (const auto& entry : static_cast<HashTable*>(object)->entries) {
+                Mark(entry.value);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void Heap::Sweep() {
+    for (uint8_t i = 0; i < kSizeClasses.size(); ++i) {
+        SweepSizeClass(i);
+    }
+    SweepLargeObjects();
+}
+
+void Heap::SweepLargeObjects() {
+    std::erase_if(large_objects_, [this](const LargeObject& large) {
+        if (large.object->marked) {
+            large.object->marked = false;
+            return false;
+        }
+        Destroy(large.object);
+        ::operator delete(large.object);
+        stats_.bytes_freed += large.size;
+        stats_.live_bytes -= large.size;
+        return true;
+    });
+}
+
+// Список свободных слотов строится заново, полностью пустые арены возвращаются системе.
+void Heap::SweepSizeClass(uint8_t size_class) {
+    auto size = kSizeClasses[size_class];
+    auto& [arenas, free_list] = size_classes_[size_class];
+    free_list = nullptr;
+
+    std::erase_if(arenas, [&, &free_list = free_list](const Arena& arena) {
+        auto* arena_free_list = free_list;
+        auto has_live = false;
+        for (size_t offset = 0; offset + size <= arena.size; offset += size) {
+            auto* object = reinterpret_cast<HeapObject*>(arena.memory.get() + offset);
+            if (object->type != ObjectType::kFree) {
+                if (object->marked) {
+                    object->marked = false;
+                    has_live = true;
+                    continue;
+                }
+                Destroy(object);
+                stats_.bytes_freed += size;
+                stats_.live_bytes -= size;
+            }
+            free_list = new (object) FreeSlot{HeapObject{ObjectType::kFree}, free_list};
+        }
+        if (!has_live) {
+            free_list = arena_free_list;
+        }
+        return !has_live;
+    });
+}
+
+// В отличие от SweepSizeClass не перестраивает список свободных слотов, а дописывает в него
+// освобожденные: свободные слоты арены уже в нем. Поэтому пустые арены остаются до полной сборки.
+size_t Heap::SweepArena(uint8_t size_class, const Arena& arena) {
+    auto size = kSizeClasses[size_class];
+    auto& free_list = size_classes_[size_class].free_list;
+    size_t slots = 0;
+    for (size_t offset = 0; offset + size <= arena.size; offset += size, ++slots) {
+        auto* object = reinterpret_cast<HeapObject*>(arena.memory.get() + offset);
+        if (object->type == ObjectType::kFree) {
+            continue;
+        }
+        if (object->marked) {
+            object->marked = false;
+            continue;
+        }
+        Destroy(object);
+        stats_.bytes_freed += size;
+        stats_.live_bytes -= size;
+        free_list = new (object) FreeSlot{HeapObject{ObjectType::kFree}, free_list};
+    }
+    return slots;
+}
+
+// Очищает арены, пока не потрачен budget слотов; true, когда очищены все.
+bool Heap::SweepStep(size_t budget) {
+    size_t work = 0;
+    while (sweep_class_ < kSizeClasses.size()) {
+        const auto& arenas = size_classes_[sweep_class_].arenas;
+        if (sweep_arena_ == arenas.size()) {
+            ++sweep_class_;
+            sweep_arena_ = 0;
+            continue;
+        }
+        if (work >= budget) {
+            return false;
+        }
+        work += SweepArena(static_cast<uint8_t>(sweep_class_), arenas[sweep_arena_++]);
+    }
+    return true;
+}
+
+void Heap::FinishSweep() {
+    for (auto* object : allocated_while_sweeping_) {
+        object->marked = false;
+    }
+    allocated_while_sweeping_.clear();
+    phase_ = Phase::kIdle;
+    ++stats_.collections;
+}
+
+void Heap::RecordPause(std::chrono::nanoseconds pause) {
+    ++stats_.increments;
+    stats_.last_pause = pause;
+    stats_.max_pause = std::max(stats_.max_pause, pause);
+    stats_.total_pause += pause;
+
+    auto microseconds = std::chrono::duration_cast<std::chrono::microseconds>(pause).count();
+    size_t bucket = microseconds > 0 ? std::bit_width(static_cast<uint64_t>(microseconds)) : 0;
+    ++stats_.pause_histogram[std::min(bucket, kPauseHistogramSize - 1)];
+}
+
+void Heap::Destroy(HeapObject* object) {
+    switch (object->type) {
+        case ObjectType::kCode:
+            static_cast<Code*>(object)->~Code();
+            break;
+        case ObjectType::kHashTable: {
+            auto* table = static_cast<HashTable*>(object);
+            stats_.bytes_freed += table->GetExternalBytes();
+            stats_.live_bytes -= table->GetExternalBytes();
+            table->~HashTable();
+            break;
+        }
+        default:
+            break;
+    }
+    object->type = ObjectType::kFree;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <value.h>
+#include <profiler.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+class Heap;
+
+// Паузы по степеням двойки в микросекундах: в корзине 0 паузы короче 1 мкс,
+// в корзине i - от 2^(i-1) до 2^i мкс, в последней - все более длинные.
+constexpr size_t kPauseHistogramSize = 24;
+
+struct GcStats {
+    // Завершенные циклы сборки и отдельные паузы; без инкрементального режима они совпадают.
+    size_t collections = 0;
+    size_t increments = 0;
+    size_t allocations = 0;
+    size_t bytes_allocated = 0;
+    size_t bytes_freed = 0;
+    size_t live_bytes = 0;
+    std::chrono::nanoseconds last_pause{};
+    std::chrono::nanoseconds max_pause{};
+    std::chrono::nanoseconds total_pause{};
+    std::array<size_t, kPauseHistogramSize> pause_histogram{};
+};
+
+// Источник корней для сборщика: глобальные переменные, стек виртуальной машины.
+class RootSet {
+public:
+    virtual void TraceRoots(Heap* heap) = 0;
+
+protected:
+    ~RootSet() = default;
+};
+
+// Куча с mark-and-sweep сборкой. Мелкие объекты нарезаются из арен по размерным классам,
+// крупные выделяются отдельно. Сборка никогда не запускается внутри Make*: владелец кучи
+// проверяет ShouldCollect() в точках, где все живые значения достижимы из корней,
+// и вызывает CollectStep().
+//
+// В инкрементальном режиме цикл сборки разбит на шаги между которыми выполняется программа.
+// Разметка трехцветная: серые объекты лежат в mark_stack_, черные - отмеченные и уже
+// просмотренные. Каждая запись ссылки в существующий объект должна проходить через
+// WriteBarrier, который красит записываемое значение в серый, так что черный объект
+// никогда не ссылается на белый. Корни не защищены барьером, поэтому в конце разметки
+// они просматриваются повторно, пока это добавляет новые серые объекты.
+// Очистка тоже идет порциями по аренам.
+class Heap {
+public:
+    static constexpr size_t kDefaultThreshold = 1 << 20;
+    static constexpr size_t kDefaultIncrementBudget = 4096;
+    // Больше элементов в векторе не бывает: размер объекта в байтах не переполняется,
+    // а просьба о большем - ошибка программы, а не повод исчерпать память.
+    static constexpr size_t kMaxVectorSize = size_t{1} << 28;
+
+    Heap() = default;
+    ~Heap();
+
+    Heap(const Heap&) = delete;
+    Heap& operator=(const Heap&) = delete;
+
+    template <class T, class... Args>
+    T* Make(Args&&... args) {
+        return OnCreate(new (Allocate(sizeof(T))) T(std::forward<Args>(args)...));
+    }
+
+    Environment* MakeEnvironment(Environment* parent, size_t size);
+    Bignum* MakeBignum(bool negative, size_t size);
+    Vector* MakeVector(size_t size, Value fill);
+    Value MakePair(Value first, Value second);
+
+    // Объект держит память вне кучи (ячейки хеш-таблицы) и заменил old_bytes на new_bytes.
+    // Эта память учитывается в статистике и пороге сборки наравне с объектами; при
+    // освобождении объекта ее вычитает Destroy.
+    void OnExternalResize(size_t old_bytes, size_t new_bytes);
+
+    void AddRootSet(RootSet* roots);
+    void RemoveRootSet(RootSet* roots);
+
+    // Вызывается из RootSet::TraceRoots.
+    void Mark(Value value);
+
+    // Во время инкрементального цикла шаги идут чаще: на каждый выделенный байт приходится
+    // столько работы сборщика, что разметка и очистка обгоняют программу.
+    bool ShouldCollect() const {
+        return allocated_since_collection_ >=
+               (phase_ == Phase::kIdle ? threshold_ : increment_interval_);
+    }
+
+    // Полная сборка; начатый инкрементальный цикл при этом доводится до конца.
+    void Collect();
+
+    // Полная сборка или, в инкрементальном режиме, очередной шаг цикла.
+    void CollectStep();
+
+    void WriteBarrier(Value value) {
+        if (phase_ == Phase::kMarking) {
+            Mark(value);
+        }
+    }
+
+    // Сколько байт можно выделить между сборками.
+    void SetCollectionThreshold(size_t bytes);
+
+    void SetIncremental(bool incremental);
+    // Работа одного шага: столько объектов размечается или слотов очищается за раз.
+    void SetIncrementBudget(size_t budget);
+
+    const GcStats& GetStats() const;
+
+    // Полная сборка, после которой все живые объекты становятся неизменяемыми и навсегда
+    // отмеченными: сборщики других куч, до которых доходят ссылки на них, не пишут в них
+    // и не заходят внутрь, так что их можно читать из нескольких потоков сразу.
+    // После заморозки куча больше не используется для выделения.
+    void Freeze();
+
+    // Подключенный профилировщик узнает о каждом выделении; nullptr - отключен.
+    void SetProfiler(Profiler* profiler);
+    Profiler* GetProfiler() const;
+
+private:
+    static constexpr std::array<size_t, 8> kSizeClasses = {16, 32, 48, 64, 96, 128, 192, 256};
+    // Первая арена размерного класса маленькая, следующие вдвое больше предыдущей:
+    // интерпретатору, которому почти ничего не нужно выделять, не нужно и много памяти.
+    static constexpr size_t kMinArenaSize = 4 << 10;
+    static constexpr size_t kMaxArenaSize = 64 << 10;
+    // Самый маленький объект занимает 16 байт, так что за шаг размечается в 4 раза больше,
+    // чем выделено с прошлого шага.
+    static constexpr size_t kBytesPerWorkUnit = 4;
+    static constexpr size_t kMaxRescans = 16;
+
+    enum class Phase : uint8_t {
+        kIdle,
+        kMarking,
+        kSweeping,
+    };
+
+    struct FreeSlot : HeapObject {
+        FreeSlot* next;
+    };
+
+    struct Arena {
+        std::unique_ptr<std::byte[]> memory;
+        size_t size;
+    };
+
+    struct SizeClass {
+        std::vector<Arena> arenas;
+        FreeSlot* free_list = nullptr;
+    };
+
+    struct LargeObject {
+        HeapObject* object;
+        size_t size;
+    };
+
+    void* Allocate(size_t size);
+
+    // Объект, созданный во время очистки, сразу отмечен, иначе очистка освободит его,
+    // если дойдет до его арены позже.
+    template <class T>
+    T* OnCreate(T* object) {
+        if (phase_ == Phase::kSweeping) {
+            object->marked = true;
+            allocated_while_sweeping_.push_back(object);
+        }
+        return object;
+    }
+
+    void AddArena(uint8_t size_class);
+    void OnAllocate(size_t size);
+    // Все живые объекты, и мелкие, и крупные.
+    template <class Function>
+    void ForEachObject(Function function);
+    void TraceRoots();
+    void TraceChildren(HeapObject* object);
+    size_t Drain(size_t budget);
+    void Sweep();
+    void SweepSizeClass(uint8_t size_class);
+    void SweepLargeObjects();
+    size_t SweepArena(uint8_t size_class, const Arena& arena);
+    bool SweepStep(size_t budget);
+    void FinishSweep();
+    void RecordPause(std::chrono::nanoseconds pause);
+    void Destroy(HeapObject* object);
+
+    std::array<SizeClass, kSizeClasses.size()> size_classes_;
+    std::vector<LargeObject> large_objects_;
+
+    std::vector<RootSet*> root_sets_;
+    std::vector<HeapObject*> mark_stack_;
+
+    bool incremental_ = false;
+    size_t increment_budget_ = kDefaultIncrementBudget;
+    size_t increment_interval_ = kDefaultIncrementBudget * kBytesPerWorkUnit;
+    Phase phase_ = Phase::kIdle;
+    size_t rescans_ = 0;
+    // Позиция инкрементальной очистки: размерный класс и арена в нем.
+    size_t sweep_class_ = 0;
+    size_t sweep_arena_ = 0;
+    // Отметки с них снимаются, когда очистка закончится.
+    std::vector<HeapObject*> allocated_while_sweeping_;
+
+    Profiler* profiler_ = nullptr;
+
+    size_t threshold_ = kDefaultThreshold;
+    size_t allocated_since_collection_ = 0;
+    GcStats stats_;
+};
@@ -0,0 +1,735 @@
+#include <heap_image.h>
+#include <builtins.h>
+#include <bytecode.h>
+#include <error.h>
+#include <hash_table.h>
+#include <procedure.h>
+#include <symbols.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Формат: сигнатура, таблица имен символов, заголовки объектов (тип и размер - все,
+// что нужно, чтобы выделить объект), тела объектов, глобальные переменные.
+// Все целые записаны как varint, значения - байт вида и, если нужно, число.
+// Заголовки идут отдельно от тел, чтобы при чтении сначала выделить все объекты,
+// а потом заполнить ссылки, в том числе циклические.
+
+namespace {
+
+constexpr std::string_view kSignature = "SCMIMG01";
+
+enum class ValueKind : uint8_t {
+    kNil,
+    kFixnum,
+    kFalse,
+    kTrue,
+    kSymbol,
+    kObject,
+};
+
+// Кроме явных обращений к глобальным переменным, слот исходной функции хранят примитивы.
+bool HasGlobalSlot(OpCode op) {
+    switch (op) {
+        case OpCode::kLoadGlobal:
+        case OpCode::kStoreGlobal:
+        case OpCode::kDefineGlobal:
+            return true;
+        default:
+            return op >= OpCode::kAdd;
+    }
+}
+
+class ImageWriter {
+public:
+    std::string Write(const Globals& globals) {
+        std::string globals_section;
+        uint64_t defined = 0;
+        for (size_t i = 0; i < globals.GetSlotCount(); ++i) {
+            if (globals.IsDefined(i)) {
+                ++defined;
+            }
+        }
+        WriteVarint(&globals_section, defined);
+        for (size_t i = 0; i < globals.GetSlotCount(); ++i) {
+            if (globals.IsDefined(i)) {
+                WriteVarint(&globals_section, AddSymbol(i));
+                WriteValue(&globals_section, globals.Get(i));
+                globals_section += static_cast<char>(globals.IsBuiltin(i));
+            }
+        }
+
+        // Тела могут добавлять новые объекты, они допишутся в конец objects_.
+        std::string bodies;
+        for (size_t i = 0; i < objects_.size(); ++i) {
+            WriteBody(&bodies, objects_[i]);
+        }
+
+        std::string image{kSignature};
+        WriteVarint(&image, symbols_.size());
+        for (auto id : symbols_) {
+            WriteString(&image, SymbolTable::Instance().GetName(id));
+        }
+        WriteVarint(&image, objects_.size());
+        for (const auto* object : objects_) {
+            WriteHeader(&image, object);
+        }
+        return image + bodies + globals_section;
+    }
+
+private:
+    static void WriteVarint(std::string* out, uint64_t value) {
+        for (; value >= 0x80; value >>= 7) {
+            *out += static_cast<char>(value | 0x80);
+        }
+        *out += static_cast<char>(value);
+    }
+
+    static void WriteString(std::string* out, std::string_view string) {
+        WriteVarint(out, string.size());
+        *out += string;
+    }
+
+    uint64_t AddSymbol(uint32_t id) {
+        auto [it, inserted] = symbol_indices_.emplace(id, symbols_.size());
+        if (inserted) {
+            symbols_.push_back(id);
+        }
+        return it->second;
+    }
+
+    uint64_t AddObject(const HeapObject* object) {
+        auto [it, inserted] = object_indices_.emplace(object, objects_.size());
+        if (inserted) {
+            objects_.push_back(object);
+        }
+        return it->second;
+    }
+
+    void WriteValue(std::string* out, Value value) {
+        if (value.IsFixnum()) {
+            // zigzag, чтобы небольшие отрицательные числа тоже были короткими
+            auto number = value.GetFixnum();
+            auto sign = number < 0 ? ~uint64_t{0} : 0;
+            *out += static_cast<char>(ValueKind::kFixnum);
+            WriteVarint(out, (static_cast<uint64_t>(number) << 1) ^ sign);
+        } else if (value.IsBool()) {
+            *out += static_cast<char>(value.GetBool() ? ValueKind::kTrue : ValueKind::kFalse);
+        } else if (value.IsSymbol()) {
+            *out += static_cast<char>(ValueKind::kSymbol);
+            WriteVarint(out, AddSymbol(value.GetSymbol()));
+        } else if (value.IsNil()) {
+            *out += static_cast<char>(ValueKind::kNil);
+        } else {
+            *out += static_cast<char>(ValueKind::kObject);
+            WriteVarint(out, AddObject(value.GetObject()));
+        }
+    }
+
+    void WriteHeader(std::string* out, const HeapObject* object) {
+        *out += static_cast<char>(object->type);
+        switch (object->type) {
+            case ObjectType::kEnvironment:
+                WriteVarint(out, static_cast<const Environment*>(object)->size);
+                break;
+            case ObjectType::kBignum:
+                WriteVarint(out, static_cast<const Bignum*>(object)->size);
+                break;
+            case ObjectType::kVector:
+                WriteVarint(out, static_cast<const Vector*>(object)->size);
+                break;
+            case ObjectType::kBuiltin:
+                WriteString(out, static_cast<const Builtin*>(object)->name);
+                break;
+            default:
+                break;
+        }
+    }
+
+    void WriteBody(std::string* out, const HeapObject* object) {
+        switch (object->type) {
+            case ObjectType::kPair: {
+                const auto* pair = static_cast<const Pair*>(object);
+                WriteValue(out, pair->first);
+                WriteValue(out, pair->second);
+                break;
+            }
+            case ObjectType::kClosure: {
+                const auto* closure = static_cast<const Closure*>(object);
+                WriteValue(out, closure->code);
+                WriteValue(out, closure->env);
+                break;
+            }
+            case ObjectType::kEnvironment: {
+                const auto* env = static_cast<const Environment*>(object);
+                WriteValue(out, env->parent);
+                for (size_t i = 0; i < env->size; ++i) {
+                    WriteValue(out, env->Slots()[i]);
+                }
+                break;
+            }
+            case ObjectType::kCode:
+                WriteCode(out, *static_cast<const Code*>(object));
+                break;
+            case ObjectType::kBignum: {
+                const auto* bignum = static_cast<const Bignum*>(object);
+                *out += static_cast<char>(bignum->negative);
+                for (size_t i = 0; i < bignum->size; ++i) {
+                    WriteVarint(out, bignum->Limbs()[i]);
+                }
+                break;
+            }
+            case ObjectType::kVector: {
+                const auto* vector = static_cast<const Vector*>(object);
+                for (size_t i = 0; i < vector->size; ++i) {
+                    WriteValue(out, vector->Elements()[i]);
+                }
+                break;
+            }
+            case ObjectType::kHashTable: {
+                const auto* table = static_cast<const HashTable*>(object);
+                WriteVarint(out, table->size);
+                for (const auto& [key, value] : table->entries) {
+                    if (!key.IsNil()) {
+                        WriteValue(out, key);
+                        WriteValue(out, value);
+                    }
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    void WriteCode(std::string* out, const Code& code) {
+        WriteString(out, code.name);
+        WriteVarint(out, code.param_count);
+        *out += static_cast<char>(code.variadic);
+        WriteVarint(out, code.slot_count);
+        WriteVarint(out, code.instructions.size());
+        for (const auto& instruction : code.instructions) {
+            *out += static_cast<char>(instruction.op);
+            WriteVarint(out, instruction.count);
+            WriteVarint(out, HasGlobalSlot(instruction.op) ? AddSymbol(instruction.index)
+                                                           : instruction.index);
+        }
+        WriteVarint(out, code.constants.size());
+        for (auto constant : code.constants) {
+            WriteValue(out, constant);
+        }
+        WriteVarint(out, code.children.size());
+        for (const auto* child : code.children) {
+            WriteVarint(out, AddObject(child));
+        }
+    }
+
+    std::vector<uint32_t> symbols_;
+    std::unordered_map<uint32_t, uint64_t> symbol_indices_;
+    std::vector<const HeapObject*> objects_;
+    std::unordered_map<const HeapObject*, uint64_t> object_indices_;
+};
+
+class ImageReader {
+public:
+    ImageReader(std::string_view image, Heap* heap, Globals* globals)
+        : image_{image}, heap_{heap}, globals_{globals} {
+    }
+
+    void Read() {
+        if (!image_.starts_with(kSignature)) {
+            Fail();
+        }
+        image_.remove_prefix(kSignature.size());
+
+        symbols_.resize(ReadCount());
+        for (auto& symbol : symbols_) {
+            symbol = SymbolTable::Instance().Intern(ReadString());
+        }
+        objects_.resize(ReadCount());
+        for (auto& object : objects_) {
+            object = ReadHeader();
+        }
+        for (auto* object : objects_) {
+            ReadBody(object);
+        }
+        // Обращения к кадрам проверяются, когда прочитан весь код: вложенный код
+        // обращается и к кадрам того, в который вложен.
+        for (auto* object : objects_) {
+            if (object->type == ObjectType::kCode) {
+                ComputeOuterSlots(static_cast<Code*>(object));
+            }
+        }
+        for (auto* object : objects_) {
+            if (object->type == ObjectType::kClosure) {
+                CheckClosure(*static_cast<Closure*>(object));
+            }
+        }
+
+        // Переменные определяются, только когда образ прочитан целиком.
+        struct Definition {
+            uint32_t symbol;
+            Value value;
+            bool builtin;
+        };
+        std::vector<Definition> definitions(ReadCount());
+        for (auto& definition : definitions) {
+            definition.symbol = ReadSymbol();
+            definition.value = ReadValue();
+            definition.builtin = ReadByte();
+            if (definition.builtin && !definition.value.Is<Builtin>()) {
+                Fail();
+            }
+        }
+        if (!image_.empty()) {
+            Fail();
+        }
+        for (const auto& [symbol, value, builtin] : definitions) {
+            if (builtin) {
+                globals_->DefineBuiltin(SymbolTable::Instance().GetName(symbol), value);
+            } else {
+                globals_->Define(globals_->Resolve(symbol), value);
+            }
+        }
+    }
+
+private:
+    [[noreturn]] static void Fail() {
+        throw RuntimeError{"Invalid image"};
+    }
+
+    uint8_t ReadByte() {
+        if (image_.empty()) {
+            Fail();
+        }
+        auto byte = static_cast<uint8_t>(image_.front());
+        image_.remove_prefix(1);
+        return byte;
+    }
+
+    uint64_t ReadVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            auto byte = ReadByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        Fail();
+    }
+
+    // Каждый элемент занимает хотя бы байт, так что испорченный счетчик не приведет
+    // к огромному выделению памяти.
+    size_t ReadCount() {
+        auto count = ReadVarint();
+        if (count > image_.size()) {
+            Fail();
+        }
+        return count;
+    }
+
+    std::string_view ReadString() {
+        auto size = ReadCount();
+        auto string = image_.substr(0, size);
+        image_.remove_prefix(size);
+        return string;
+    }
+
+    uint32_t ReadSymbol() {
+        auto index = ReadVarint();
+        if (index >= symbols_.size()) {
+            Fail();
+        }
+        return symbols_[index];
+    }
+
+    HeapObject* ReadObject() {
+        auto index = ReadVarint();
+        if (index >= objects_.size()) {
+            Fail();
+        }
+        return objects_[index];
+    }
+
+    template <class T>
+    T* ReadObjectAs() {
+        auto value = ReadValue();
+        auto* object = value.As<T>();
+        if (!object && !value.IsNil()) {
+            Fail();
+        }
+        return object;
+    }
+
+    Value ReadValue() {
+        switch (static_cast<ValueKind>(ReadByte())) {
+            case ValueKind::kNil:
+                return {};
+            case ValueKind::kFixnum: {
+                auto zigzag = ReadVarint();
+                auto sign = -static_cast<int64_t>(zigzag & 1);
+                auto number = static_cast<int64_t>(zigzag >> 1) ^ sign;
+                if (!Value::FitsFixnum(number)) {
+                    Fail();
+                }
+                return Value::MakeFixnum(number);
+            }
+            case ValueKind::kFalse:
+                return Value::MakeBool(false);
+            case ValueKind::kTrue:
+                return Value::MakeBool(true);
+            case ValueKind::kSymbol:
+                return Value::MakeSymbol(ReadSymbol());
+            case ValueKind::kObject:
+                return ReadObject();
+            default:
+                Fail();
+        }
+    }
+
+    HeapObject* ReadHeader() {
+        switch (static_cast<ObjectType>(ReadByte())) {
+            case ObjectType::kPair:
+                return heap_->Make<Pair>(Value{}, Value{});
+            case ObjectType::kClosure:
+                return heap_->Make<Closure>(nullptr, nullptr);
+            case ObjectType::kEnvironment:
+                return heap_->MakeEnvironment(nullptr, ReadCount());
+            case ObjectType::kCode:
+                return heap_->Make<Code>();
+            case ObjectType::kBignum: {
+                auto size = ReadCount();
+                if (!size) {
+                    Fail();
+                }
+                return heap_->MakeBignum(false, size);
+            }
+            case ObjectType::kVector:
+                return heap_->MakeVector(ReadCount(), Value{});
+            case ObjectType::kHashTable:
+                return heap_->Make<HashTable>();
+            case ObjectType::kBuiltin:
+                if (auto* builtin = MakeBuiltin(heap_, ReadString())) {
+                    return builtin;
+                }
+                Fail();
+            default:
+                Fail();
+        }
+    }
+
+    void ReadBody(HeapObject* object) {
+        switch (object->type) {
+            case ObjectType::kPair: {
+                auto* pair = static_cast<Pair*>(object);
+                pair->first = ReadValue();
+                pair->second = ReadValue();
+                break;
+            }
+            case ObjectType::kClosure: {
+                auto* closure = static_cast<Closure*>(object);
+                closure->code = ReadObjectAs<Code>();
+                closure->env = ReadObjectAs<Environment>();
+                if (!closure->code) {
+                    Fail();
+                }
+                break;
+            }
+            case ObjectType::kEnvironment: {
+                auto* env = static_cast<Environment*>(object);
+                env->parent = ReadObjectAs<Environment>();
+                for (size_t i = 0; i < env->size; ++i) {
+                    env->Slots()[i] = ReadValue();
+                }
+                break;
+            }
+            case ObjectType::kCode:
+                ReadCode(static_cast<Code*>(object));
+                break;
+            case ObjectType::kBignum: {
+                auto* bignum = static_cast<Bignum*>(object);
+                bignum->negative = ReadByte();
+                for (size_t i = 0; i < bignum->size; ++i) {
+                    bignum->Limbs()[i] = static_cast<uint32_t>(ReadVarint());
+                }
+                if (!bignum->Limbs()[bignum->size - 1] || FitsFixnum(*bignum)) {
+                    Fail();
+                }
+                break;
+            }
+            case ObjectType::kVector: {
+                auto* vector = static_cast<Vector*>(object);
+                for (size_t i = 0; i < vector->size; ++i) {
+                    vector->Elements()[i] = ReadValue();
+                }
+                break;
+            }
+            case ObjectType::kHashTable: {
+                auto* table = static_cast<HashTable*>(object);
+                for (auto count = ReadCount(); count > 0; --count) {
+                    auto key = ReadValue();
+                    if (!HashTable::IsValidKey(key)) {
+                        Fail();
+                    }
+                    table->Insert(heap_, key, ReadValue());
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    // Числа, которые помещаются в fixnum, всегда хранятся как fixnum.
+    static bool FitsFixnum(const Bignum& bignum) {
+        if (bignum.size > 2) {
+            return false;
+        }
+        uint64_t magnitude = bignum.Limbs()[0];
+        if (bignum.size == 2) {
+            magnitude |= static_cast<uint64_t>(bignum.Limbs()[1]) << 32;
+        }
+        return magnitude <= (bignum.negative ? -static_cast<uint64_t>(Value::kMinFixnum)
+                                             : static_cast<uint64_t>(Value::kMaxFixnum));
+    }
+
+    void ReadCode(Code* code) {
+        code->name = ReadString();
+        code->param_count = ReadVarint();
+        code->variadic = ReadByte();
+        code->slot_count = ReadVarint();
+        if (code->slot_count > Heap::kMaxVectorSize ||
+            code->param_count + code->variadic > code->slot_count) {
+            Fail();
+        }
+        code->instructions.resize(ReadCount());
+        for (auto& instruction : code->instructions) {
+            instruction.op = static_cast<OpCode>(ReadByte());
+            if (instruction.op > OpCode::kCdr) {
+                Fail();
+            }
+            auto count = ReadVarint();
+            if (count > std::numeric_limits<uint16_t>::max()) {
+                Fail();
+            }
+            instruction.count = static_cast<uint16_t>(count);
+            if (HasGlobalSlot(instruction.op)) {
+                instruction.index = static_cast<uint32_t>(globals_->Resolve(ReadSymbol()));
+            } else {
+                auto index = ReadVarint();
+                if (index > std::numeric_limits<uint32_t>::max()) {
+                    Fail();
+                }
+                instruction.index = static_cast<uint32_t>(index);
+            }
+        }
+        code->constants.resize(ReadCount());
+        for (auto& constant : code->constants) {
+            constant = ReadValue();
+        }
+        code->children.resize(ReadCount());
+        for (auto*& child : code->children) {
+            auto* object = ReadObject();
+            if (object->type != ObjectType::kCode) {
+                Fail();
+            }
+            child = static_cast<Code*>(object);
+        }
+        CheckInstructions(*code);
+    }
+
+    // Проверяет операнды инструкций и высоту стека: компилятор переходит только вперед,
+    // поэтому высоту перед каждой инструкцией можно найти одним проходом. Инструкции,
+    // до которых выполнение не доходит, пропускаются.
+    void CheckInstructions(const Code& code) {
+        constexpr size_t kUnreachable = std::numeric_limits<size_t>::max();
+        const auto& instructions = code.instructions;
+        std::vector<size_t> heights(instructions.size() + 1, kUnreachable);
+        heights[0] = 0;
+        auto merge = [&heights](size_t pc, size_t height) {
+            if (heights[pc] == kUnreachable) {
+                heights[pc] = height;
+            } else if (heights[pc] != height) {
+                Fail();
+            }
+        };
+
+        for (size_t pc = 0; pc < instructions.size(); ++pc) {
+            auto height = heights[pc];
+            if (height == kUnreachable) {
+                continue;
+            }
+            const auto& instruction = instructions[pc];
+            size_t pops = 0;
+            size_t pushes = 0;
+            auto falls_through = true;
+            switch (instruction.op) {
+                case OpCode::kConst:
+                    if (instruction.index >= code.constants.size()) {
+                        Fail();
+                    }
+                    pushes = 1;
+                    break;
+                case OpCode::kLoadLocal:
+                case OpCode::kLoadGlobal:
+                    pushes = 1;
+                    break;
+                case OpCode::kStoreLocal:
+                case OpCode::kStoreGlobal:
+                case OpCode::kDefineGlobal:
+                    pops = pushes = 1;
+                    break;
+                case OpCode::kPop:
+                    pops = 1;
+                    break;
+                case OpCode::kJump:
+                case OpCode::kJumpIfFalse:
+                case OpCode::kJumpIfFalseOrPop:
+                case OpCode::kJumpIfTrueOrPop:
+                    if (instruction.index <= pc || instruction.index >= instructions.size()) {
+                        Fail();
+                    }
+                    if (instruction.op != OpCode::kJump && !height) {
+                        Fail();
+                    }
+                    if (instruction.op == OpCode::kJumpIfFalse) {
+                        merge(instruction.index, height - 1);
+                    } else {
+                        merge(instruction.index, height);
+                    }
+                    falls_through = instruction.op != OpCode::kJump;
+                    pops = instruction.op == OpCode::kJump ? 0 : 1;
+                    break;
+                case OpCode::kMakeClosure:
+                    if (instruction.index >= code.children.size()) {
+                        Fail();
+                    }
+                    pushes = 1;
+                    break;
+                case OpCode::kCall:
+                case OpCode::kTailCall:
+                    pops = instruction.count + 1;
+                    pushes = 1;
+                    break;
+                case OpCode::kReturn:
+                    if (height != 1) {
+                        Fail();
+                    }
+                    falls_through = false;
+                    break;
+                case OpCode::kIllFormed:
+                    falls_through = false;
+                    break;
+                default:
+                    if (instruction.op >= OpCode::kNot &&
+                        instruction.count != (instruction.op == OpCode::kCons ? 2 : 1)) {
+                        Fail();
+                    }
+                    pops = instruction.count;
+                    pushes = 1;
+                    break;
+            }
+            if (height < pops) {
+                Fail();
+            }
+            if (falls_through) {
+                merge(pc + 1, height - pops + pushes);
+            }
+        }
+        // Выполнение не должно уходить за последнюю инструкцию.
+        if (heights.back() != kUnreachable) {
+            Fail();
+        }
+    }
+
+    // Для каждого кода запоминает, сколько слотов нужно в окружениях на глубине 1, 2, ...
+    // ему самому и вложенному в него коду; глубина 0 - его собственный кадр из slot_count
+    // слотов, он проверяется сразу. Вложенный код видит этот кадр на глубине 1.
+    // Обход в глубину идет по явному стеку, чтобы длинная цепочка вложенного кода
+    // не переполнила стек вызовов.
+    void ComputeOuterSlots(Code* root) {
+        if (outer_slots_.contains(root)) {
+            return;
+        }
+        std::vector<std::pair<Code*, size_t>> path{{root, 0}};
+        std::unordered_set<const Code*> on_path{root};
+        while (!path.empty()) {
+            auto [code, next] = path.back();
+            if (next < code->children.size()) {
+                ++path.back().second;
+                auto* child = code->children[next];
+                if (on_path.contains(child)) {
+                    Fail();
+                }
+                if (!outer_slots_.contains(child)) {
+                    path.emplace_back(child, 0);
+                    on_path.insert(child);
+                }
+                continue;
+            }
+            path.pop_back();
+            on_path.erase(code);
+
+            std::vector<size_t> slots;
+            auto require = [code, &slots](size_t depth, size_t slot_count) {
+                if (!depth) {
+                    if (slot_count > code->slot_count) {
+                        Fail();
+                    }
+                    return;
+                }
+                if (slots.size() < depth) {
+                    slots.resize(depth);
+                }
+                slots[depth - 1] = std::max(slots[depth - 1], slot_count);
+            };
+            for (const auto& instruction : code->instructions) {
+                if (instruction.op == OpCode::kLoadLocal ||
+                    instruction.op == OpCode::kStoreLocal) {
+                    require(instruction.count, size_t{instruction.index} + 1);
+                }
+            }
+            for (const auto* child : code->children) {
+                const auto& child_slots = outer_slots_.at(child);
+                for (size_t depth = 0; depth < child_slots.size(); ++depth) {
+                    require(depth, child_slots[depth]);
+                }
+            }
+            outer_slots_.emplace(code, std::move(slots));
+        }
+    }
+
+    // Окружение замыкания - кадр на глубине 1 для его кода.
+    void CheckClosure(const Closure& closure) {
+        const auto* env = closure.env;
+        for (auto slot_count : outer_slots_.at(closure.code)) {
+            if (!env || env->size < slot_count) {
+                Fail();
+            }
+            env = env->parent;
+        }
+    }
+
+    std::string_view image_;
+    Heap* heap_;
+    Globals* globals_;
+    std::vector<uint32_t> symbols_;
+    std::vector<HeapObject*> objects_;
+    std::unordered_map<const Code*, std::vector<size_t>> outer_slots_;
+};
+
+}  // namespace
+
+std::string WriteImage(const Globals& globals) {
+    return ImageWriter{}.Write(globals);
+}
+
+void ReadImage(std::string_view image, Heap* heap, Globals* globals) {
+    ImageReader{image, heap, globals}.Read();
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <heap.h>
+#include <globals.h>
+
+#include <string>
+#include <string_view>
+
+// Образ кучи: определенные глобальные переменные и все достижимые из них объекты
+// (пары, векторы, хеш-таблицы, замыкания, код, окружения, большие числа)
+// в компактном двоичном виде.
+// Указатели заменены номерами объектов, символы - номерами в таблице имен самого образа,
+// встроенные функции - именами, так что образ не зависит ни от адресов, ни от того,
+// в каком порядке символы интернировались в процессе, который его записал.
+std::string WriteImage(const Globals& globals);
+
+// Определяет в globals переменные из образа. Испорченный образ - RuntimeError.
+void ReadImage(std::string_view image, Heap* heap, Globals* globals);
@@ -0,0 +1,396 @@
+#include <numbers.h>
+#include <error.h>
+
+#include <algorithm>
+#include <bit>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using Limbs = std::vector<uint32_t>;
+using LimbSpan = std::span<const uint32_t>;
+
+// Ниже этого размера (в 32-битных разрядах) школьное умножение быстрее Карацубы.
+constexpr size_t kKaratsubaThreshold = 32;
+
+constexpr uint64_t kBase = uint64_t{1} << 32;
+
+struct Integer {
+    bool negative = false;
+    Limbs magnitude;
+};
+
+void Trim(Limbs* limbs) {
+    while (!limbs->empty() && !limbs->back()) {
+        limbs->pop_back();
+    }
+}
+
+LimbSpan Trimmed(LimbSpan limbs) {
+    while (!limbs.empty() && !limbs.back()) {
+        limbs = limbs.first(limbs.size() - 1);
+    }
+    return limbs;
+}
+
+Integer FromInt64(int64_t value) {
+    Integer result;
+    result.negative = value < 0;
+    auto magnitude = value < 0 ? -static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    for (; magnitude; magnitude >>= 32) {
+        result.magnitude.push_back(static_cast<uint32_t>(magnitude));
+    }
+    return result;
+}
+
+Integer ToInteger(Value value) {
+    if (value.IsFixnum()) {
+        return FromInt64(value.GetFixnum());
+    }
+    const auto* bignum = value.As<Bignum>();
+    return {bignum->negative, Limbs(bignum->Limbs(), bignum->Limbs() + bignum->size)};
+}
+
+Value ToValue(Heap* heap, const Integer& integer) {
+    const auto& magnitude = integer.magnitude;
+    if (magnitude.size() <= 2) {
+        uint64_t value = 0;
+        for (auto it = magnitude.rbegin(); it != magnitude.rend(); ++it) {
+            value = (value << 32) | *it;
+        }
+        auto limit = static_cast<uint64_t>(Value::kMaxFixnum) + (integer.negative ? 1 : 0);
+        if (value <= limit) {
+            return Value::MakeFixnum(integer.negative ? static_cast<int64_t>(0 - value)
+                                                      : static_cast<int64_t>(value));
+        }
+    }
+    auto* bignum = heap->MakeBignum(integer.negative, magnitude.size());
+    std::copy(magnitude.begin(), magnitude.end(), bignum->Limbs());
+    return bignum;
+}
+
+int CompareMagnitudes(LimbSpan lhs, LimbSpan rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size() ? -1 : 1;
+    }
+    for (auto i = lhs.size(); i-- > 0;) {
+        if (lhs[i] != rhs[i]) {
+            return lhs[i] < rhs[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+Limbs AddMagnitudes(LimbSpan lhs, LimbSpan rhs) {
+    if (lhs.size() < rhs.size()) {
+        std::swap(lhs, rhs);
+    }
+    Limbs result(lhs.size() + 1);
+    uint64_t carry = 0;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        auto sum = lhs[i] + (i < rhs.size() ? rhs[i] : uint64_t{0}) + carry;
+        result[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+    result.back() = static_cast<uint32_t>(carry);
+    Trim(&result);
+    return result;
+}
+
+// lhs >= rhs.
+Limbs SubtractMagnitudes(LimbSpan lhs, LimbSpan rhs) {
+    Limbs result(lhs.size());
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        auto subtrahend = (i < rhs.size() ? rhs[i] : uint64_t{0}) + borrow;
+        borrow = lhs[i] < subtrahend;
+        result[i] = static_cast<uint32_t>(lhs[i] + (borrow ? kBase : 0) - subtrahend);
+    }
+    Trim(&result);
+    return result;
+}
+
+// result += addend * base^shift; результат заведомо помещается в result.
+void AddShifted(Limbs* result, LimbSpan addend, size_t shift) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < addend.size() || carry; ++i) {
+        auto& limb = (*result)[shift + i];
+        auto sum = limb + (i < addend.size() ? addend[i] : uint64_t{0}) + carry;
+        limb = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+    }
+}
+
+Limbs MultiplySchoolbook(LimbSpan lhs, LimbSpan rhs) {
+    if (lhs.empty() || rhs.empty()) {
+        return {};
+    }
+    Limbs result(lhs.size() + rhs.size());
+    for (size_t i = 0; i < lhs.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < rhs.size(); ++j) {
+            auto product = uint64_t{lhs[i]} * rhs[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(product);
+            carry = product >> 32;
+        }
+        result[i + rhs.size()] = static_cast<uint32_t>(carry);
+    }
+    Trim(&result);
+    return result;
+}
+
+Limbs MultiplyMagnitudes(LimbSpan lhs, LimbSpan rhs) {
+    lhs = Trimmed(lhs);
+    rhs = Trimmed(rhs);
+    if (lhs.size() < rhs.size()) {
+        std::swap(lhs, rhs);
+    }
+    if (rhs.size() < kKaratsubaThreshold) {
+        return MultiplySchoolbook(lhs, rhs);
+    }
+
+    auto half = lhs.size() / 2;
+    auto lhs_low = lhs.first(half);
+    auto lhs_high = lhs.subspan(half);
+    Limbs result(lhs.size() + rhs.size() + 1);
+
+    // Короткий множитель целиком в младшей половине: хватает двух умножений.
+    if (rhs.size() <= half) {
+        AddShifted(&result, MultiplyMagnitudes(lhs_low, rhs), 0);
+        AddShifted(&result, MultiplyMagnitudes(lhs_high, rhs), half);
+        Trim(&result);
+        return result;
+    }
+
+    auto rhs_low = rhs.first(half);
+    auto rhs_high = rhs.subspan(half);
+    auto low = MultiplyMagnitudes(lhs_low, rhs_low);
+    auto high = MultiplyMagnitudes(lhs_high, rhs_high);
+    auto middle = MultiplyMagnitudes(AddMagnitudes(lhs_low, lhs_high),
+                                     AddMagnitudes(rhs_low, rhs_high));
+    middle = SubtractMagnitudes(middle, low);
+    middle = SubtractMagnitudes(middle, high);
+
+    AddShifted(&result, low, 0);
+    AddShifted(&result, middle, half);
+    AddShifted(&result, high, 2 * half);
+    Trim(&result);
+    return result;
+}
+
+// Делит на месте, возвращает остаток.
+uint32_t DivideBySmall(Limbs* limbs, uint32_t divisor) {
+    uint64_t remainder = 0;
+    for (auto i = limbs->size(); i-- > 0;) {
+        auto current = (remainder << 32) | (*limbs)[i];
+        (*limbs)[i] = static_cast<uint32_t>(current / divisor);
+        remainder = current % divisor;
+    }
+    Trim(limbs);
+    return static_cast<uint32_t>(remainder);
+}
+
+// Алгоритм D из TAOCP 4.3.1, divisor не пуст.
+Limbs DivideMagnitudes(LimbSpan dividend, LimbSpan divisor) {
+    if (CompareMagnitudes(dividend, divisor) < 0) {
+        return {};
+    }
+    if (divisor.size() == 1) {
+        Limbs quotient(dividend.begin(), dividend.end());
+        DivideBySmall(&quotient, divisor[0]);
+        return quotient;
+    }
+
+    // Нормализация: старший бит делителя должен быть единицей.
+    auto n = divisor.size();
+    auto m = dividend.size() - n;
+    auto shift = std::countl_zero(divisor.back());
+    auto shifted = [shift](LimbSpan limbs, size_t i) {
+        auto high = i < limbs.size() ? uint64_t{limbs[i]} << shift : 0;
+        auto low = i > 0 ? uint64_t{limbs[i - 1]} >> (32 - shift) : 0;
+        return static_cast<uint32_t>(high | low);
+    };
+    Limbs v(n);
+    for (size_t i = 0; i < n; ++i) {
+        v[i] = shifted(divisor, i);
+    }
+    Limbs u(dividend.size() + 1);
+    for (size_t i = 0; i <= dividend.size(); ++i) {
+        u[i] = shifted(dividend, i);
+    }
+
+    Limbs quotient(m + 1);
+    for (auto j = m + 1; j-- > 0;) {
+        auto numerator = (uint64_t{u[j + n]} << 32) | u[j + n - 1];
+        auto estimate = numerator / v[n - 1];
+        auto remainder = numerator % v[n - 1];
+        while (estimate >= kBase || estimate * v[n - 2] > ((remainder << 32) | u[j + n - 2])) {
+            --estimate;
+            remainder += v[n - 1];
+            if (remainder >= kBase) {
+                break;
+            }
+        }
+
+        int64_t borrow = 0;
+        for (size_t i = 0; i < n; ++i) {
+            auto product = estimate * v[i];
+            auto low = static_cast<int64_t>(product & 0xffffffff);
+            auto difference = int64_t{u[i + j]} - borrow - low;
+            u[i + j] = static_cast<uint32_t>(difference);
+            borrow = static_cast<int64_t>(product >> 32) - (difference >> 32);
+        }
+        auto difference = int64_t{u[j + n]} - borrow;
+        u[j + n] = static_cast<uint32_t>(difference);
+
+        // Оценка оказалась на единицу больше: добавляем делитель обратно.
+        if (difference < 0) {
+            --estimate;
+            uint64_t carry = 0;
+            for (size_t i = 0; i < n; ++i) {
+                auto sum = uint64_t{u[i + j]} + v[i] + carry;
+                u[i + j] = static_cast<uint32_t>(sum);
+                carry = sum >> 32;
+            }
+            u[j + n] += static_cast<uint32_t>(carry);
+        }
+        quotient[j] = static_cast<uint32_t>(estimate);
+    }
+    Trim(&quotient);
+    return quotient;
+}
+
+Integer AddIntegers(const Integer& lhs, const Integer& rhs) {
+    if (lhs.negative == rhs.negative) {
+        return {lhs.negative, AddMagnitudes(lhs.magnitude, rhs.magnitude)};
+    }
+    if (CompareMagnitudes(lhs.magnitude, rhs.magnitude) >= 0) {
+        return {lhs.negative, SubtractMagnitudes(lhs.magnitude, rhs.magnitude)};
+    }
+    return {rhs.negative, SubtractMagnitudes(rhs.magnitude, lhs.magnitude)};
+}
+
+}  // namespace
+
+bool IsNumber(Value value) {
+    return value.IsFixnum() || value.Is<Bignum>();
+}
+
+bool IsNegative(Value value) {
+    return value.IsFixnum() ? value.GetFixnum() < 0 : value.As<Bignum>()->negative;
+}
+
+Value MakeInteger(Heap* heap, int64_t value) {
+    if (Value::FitsFixnum(value)) {
+        return Value::MakeFixnum(value);
+    }
+    return ToValue(heap, FromInt64(value));
+}
+
+// Сумма и разность двух fixnum помещаются в int64_t, произведение - не всегда.
+Value Add(Heap* heap, Value lhs, Value rhs) {
+    if (lhs.IsFixnum() && rhs.IsFixnum()) {
+        return MakeInteger(heap, lhs.GetFixnum() + rhs.GetFixnum());
+    }
+    return ToValue(heap, AddIntegers(ToInteger(lhs), ToInteger(rhs)));
+}
+
+Value Subtract(Heap* heap, Value lhs, Value rhs) {
+    if (lhs.IsFixnum() && rhs.IsFixnum()) {
+        return MakeInteger(heap, lhs.GetFixnum() - rhs.GetFixnum());
+    }
+    auto negated = ToInteger(rhs);
+    negated.negative = !negated.negative;
+    return ToValue(heap, AddIntegers(ToInteger(lhs), negated));
+}
+
+Value Multiply(Heap* heap, Value lhs, Value rhs) {
+    if (lhs.IsFixnum() && rhs.IsFixnum()) {
+        int64_t product;
+        if (!__builtin_mul_overflow(lhs.GetFixnum(), rhs.GetFixnum(), &product)) {
+            return MakeInteger(heap, product);
+        }
+    }
+    auto a = ToInteger(lhs);
+    auto b = ToInteger(rhs);
+    return ToValue(heap, {a.negative != b.negative, MultiplyMagnitudes(a.magnitude, b.magnitude)});
+}
+
+Value Divide(Heap* heap, Value lhs, Value rhs) {
+    if (rhs == Value::MakeFixnum(0)) {
+        throw RuntimeError{"Division by zero"};
+    }
+    if (lhs.IsFixnum() && rhs.IsFixnum()) {
+        return MakeInteger(heap, lhs.GetFixnum() / rhs.GetFixnum());
+    }
+    auto a = ToInteger(lhs);
+    auto b = ToInteger(rhs);
+    return ToValue(heap, {a.negative != b.negative, DivideMagnitudes(a.magnitude, b.magnitude)});
+}
+
+Value Negate(Heap* heap, Value value) {
+    return Subtract(heap, Value::MakeFixnum(0), value);
+}
+
+int Compare(Value lhs, Value rhs) {
+    if (lhs.IsFixnum() && rhs.IsFixnum()) {
+        auto a = lhs.GetFixnum();
+        auto b = rhs.GetFixnum();
+        return a < b ? -1 : (a > b ? 1 : 0);
+    }
+    auto a = ToInteger(lhs);
+    auto b = ToInteger(rhs);
+    if (a.negative != b.negative) {
+        return a.negative ? -1 : 1;
+    }
+    auto result = CompareMagnitudes(a.magnitude, b.magnitude);
+    return a.negative ? -result : result;
+}
+
+std::string NumberToString(Value value) {
+    if (value.IsFixnum()) {
+        return std::to_string(value.GetFixnum());
+    }
+    constexpr uint32_t kChunk = 1'000'000'000;
+    auto integer = ToInteger(value);
+    std::vector<uint32_t> chunks;
+    while (!integer.magnitude.empty()) {
+        chunks.push_back(DivideBySmall(&integer.magnitude, kChunk));
+    }
+    std::string result = integer.negative ? "-" : "";
+    result += std::to_string(chunks.back());
+    for (auto it = chunks.rbegin() + 1; it != chunks.rend(); ++it) {
+        auto chunk = std::to_string(*it);
+        result += std::string(9 - chunk.size(), '0') + chunk;
+    }
+    return result;
+}
+
+Value NumberFromString(Heap* heap, std::string_view text) {
+    constexpr uint32_t kChunk = 1'000'000'000;
+    constexpr size_t kChunkDigits = 9;
+    Integer integer;
+    integer.negative = text.starts_with('-');
+    if (text.starts_with('-') || text.starts_with('+')) {
+        text.remove_prefix(1);
+    }
+    // Первый кусок короче, чтобы остальные были ровно по kChunkDigits цифр.
+    auto size = (text.size() - 1) % kChunkDigits + 1;
+    for (; !text.empty(); text.remove_prefix(size), size = kChunkDigits) {
+        uint64_t carry = 0;
+        for (auto digit : text.substr(0, size)) {
+            carry = carry * 10 + (digit - '0');
+        }
+        for (auto& limb : integer.magnitude) {
+            auto current = uint64_t{limb} * kChunk + carry;
+            limb = static_cast<uint32_t>(current);
+            carry = current >> 32;
+        }
+        if (carry) {
+            integer.magnitude.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+    return ToValue(heap, integer);
+}
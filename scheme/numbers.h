@@ -0,0 +1,31 @@
+#pragma once
+
+#include <value.h>
+#include <heap.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Целые числа произвольной длины. Пока аргументы - fixnum, операции считаются
+// в машинных словах, Bignum появляется только при переполнении. Результат всегда
+// нормализован: число, которое помещается в fixnum, возвращается как fixnum.
+
+bool IsNumber(Value value);
+bool IsNegative(Value value);
+
+Value MakeInteger(Heap* heap, int64_t value);
+
+Value Add(Heap* heap, Value lhs, Value rhs);
+Value Subtract(Heap* heap, Value lhs, Value rhs);
+Value Multiply(Heap* heap, Value lhs, Value rhs);
+// Частное с отбрасыванием дробной части, как в C++. Деление на ноль - RuntimeError.
+Value Divide(Heap* heap, Value lhs, Value rhs);
+Value Negate(Heap* heap, Value value);
+
+// Отрицательное, ноль или положительное, как std::strcmp.
+int Compare(Value lhs, Value rhs);
+
+std::string NumberToString(Value value);
+// Обратное к NumberToString: необязательный знак и десятичные цифры.
+Value NumberFromString(Heap* heap, std::string_view text);
@@ -0,0 +1,102 @@
+#include <object.h>
+#include <symbols.h>
+
+#include <sstream>
+
+namespace {
+
+void Print(std::ostream& out, const std::shared_ptr<Object>& obj);
+
+void PrintList(std::ostream& out, const Cell& cell) {
+    out << '(';
+    Print(out, cell.GetFirst());
+    auto tail = cell.GetSecond();
+    while (const auto* next = dynamic_cast<const Cell*>(tail.get())) {
+        out << ' ';
+        Print(out, next->GetFirst());
+        tail = next->GetSecond();
+    }
+    if (tail) {
+        out << " . ";
+        Print(out, tail);
+    }
+    out << ')';
+}
+
+void Print(std::ostream& out, const std::shared_ptr<Object>& obj) {
+    if (!obj) {
+        out << "()";
+    } else if (const auto* number = dynamic_cast<const Number*>(obj.get())) {
+        out << number->GetValue();
+    } else if (const auto* symbol = dynamic_cast<const Symbol*>(obj.get())) {
+        out << symbol->GetName();
+    } else if (const auto* boolean = dynamic_cast<const Boolean*>(obj.get())) {
+        out << (boolean->GetValue() ? "#t" : "#f");
+    } else if (const auto* cell = dynamic_cast<const Cell*>(obj.get())) {
+        PrintList(out, *cell);
+    } else {
+        out << "#<object>";
+    }
+}
+
+}  // namespace
+
+Number::Number(int64_t value) : value_{value} {
+}
+
+int64_t Number::GetValue() const {
+    return value_;
+}
+
+Symbol::Symbol(uint32_t id) : id_{id} {
+}
+
+Symbol::Symbol(std::string_view name) : id_{SymbolTable::Instance().Intern(name)} {
+}
+
+uint32_t Symbol::GetId() const {
+    return id_;
+}
+
+const std::string& Symbol::GetName() const {
+    return SymbolTable::Instance().GetName(id_);
+}
+
+Boolean::Boolean(bool value) : value_{value} {
+}
+
+bool Boolean::GetValue() const {
+    return value_;
+}
+
+Cell::Cell(std::shared_ptr<Object> first, std::shared_ptr<Object> second)
+    : first_{std::move(first)}, second_{std::move(second)} {
+}
+
+std::shared_ptr<Object> Cell::GetFirst() const {
+    return first_;
+}
+
+std::shared_ptr<Object> Cell::GetSecond() const {
+    return second_;
+}
+
+void Cell::SetFirst(std::shared_ptr<Object> first) {
+    first_ = std::move(first);
+}
+
+void Cell::SetSecond(std::shared_ptr<Object> second) {
+    second_ = std::move(second);
+}
+
+std::shared_ptr<Object> MakeBoolean(bool value) {
+    static const std::shared_ptr<Object> kTrue = std::make_shared<Boolean>(true);
+    static const std::shared_ptr<Object> kFalse = std::make_shared<Boolean>(false);
+    return value ? kTrue : kFalse;
+}
+
+std::string ToString(const std::shared_ptr<Object>& obj) {
+    std::ostringstream out;
+    Print(out, obj);
+    return out.str();
+}
@@ -1,7 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <string_view>
 
 class Object : public std::enable_shared_from_this<Object> {
 public:
@@ -10,22 +12,63 @@ public:
 
 class Number : public Object {
 public:
-    int GetValue() const;
+    explicit Number(int64_t value);
+
+    int64_t GetValue() const;
+
+private:
+    int64_t value_;
 };
 
+// Хранит номер в SymbolTable, имя берется из таблицы.
 class Symbol : public Object {
 public:
+    explicit Symbol(uint32_t id);
+    explicit Symbol(std::string_view name);
+
+    uint32_t GetId() const;
     const std::string& GetName() const;
+
+private:
+    uint32_t id_;
+};
+
+class Boolean : public Object {
+public:
+    explicit Boolean(bool value);
+
+    bool GetValue() const;
+
+private:
+    bool value_;
 };
 
 class Cell : public Object {
 public:
+    Cell(std::shared_ptr<Object> first, std::shared_ptr<Object> second);
+
     std::shared_ptr<Object> GetFirst() const;
     std::shared_ptr<Object> GetSecond() const;
+
+    void SetFirst(std::shared_ptr<Object> first);
+    void SetSecond(std::shared_ptr<Object> second);
+
+private:
+    std::shared_ptr<Object> first_;
+    std::shared_ptr<Object> second_;
 };
 
 template <class T>
-std::shared_ptr<T> As(const std::shared_ptr<Object>& obj);
+std::shared_ptr<T> As(const std::shared_ptr<Object>& obj) {
+    return std::dynamic_pointer_cast<T>(obj);
+}
 
 template <class T>
-bool Is(const std::shared_ptr<Object>& obj);
+bool Is(const std::shared_ptr<Object>& obj) {
+    return dynamic_cast<const T*>(obj.get()) != nullptr;
+}
+
+// #t и #f - разделяемые объекты-синглтоны.
+std::shared_ptr<Object> MakeBoolean(bool value);
+
+std::string ToString(const std::shared_ptr<Object>& obj);
@@ -1,10 +1,95 @@
-#include <object.h>
 #include <parser.h>
-#include <tokenizer.h>
+#include <error.h>
+#include <symbols.h>
 
-#include <stdexcept>
 #include <memory>
 
+namespace {
+
+const Node* ReadObject(Tokenizer* tokenizer, Arena* arena);
+
+void Expect(Tokenizer* tokenizer, BracketToken bracket) {
+    if (tokenizer->IsEnd()) {
+        throw SyntaxError{"Unexpected end of input"};
+    }
+    auto token = tokenizer->GetToken();
+    const auto* p = std::get_if<BracketToken>(&token);
+    if (!p || *p != bracket) {
+        throw SyntaxError{"Unexpected token"};
+    }
+    tokenizer->Next();
+}
+
+// Вызывается после открывающей скобки, съедает закрывающую.
+const Node* ReadList(Tokenizer* tokenizer, Arena* arena) {
+    const Node* head = nullptr;
+    CellNode* tail = nullptr;
+    while (true) {
+        if (tokenizer->IsEnd()) {
+            throw SyntaxError{"Unexpected end of input"};
+        }
+        auto token = tokenizer->GetToken();
+        if (const auto* bracket = std::get_if<BracketToken>(&token);
+            bracket && *bracket == BracketToken::CLOSE) {
+            tokenizer->Next();
+            return head;
+        } else if (std::holds_alternative<DotToken>(token)) {
+            if (!tail) {
+                throw SyntaxError{"Unexpected dot"};
+            }
+            tokenizer->Next();
+            tail->second = ReadObject(tokenizer, arena);
+            Expect(tokenizer, BracketToken::CLOSE);
+            return head;
+        }
+
+        auto* cell = arena->Make<CellNode>(ReadObject(tokenizer, arena), nullptr);
+        if (tail) {
+            tail->second = cell;
+        } else {
+            head = cell;
+        }
+        tail = cell;
+    }
+}
+
+const Node* ReadObject(Tokenizer* tokenizer, Arena* arena) {
+    if (tokenizer->IsEnd()) {
+        throw SyntaxError{"Unexpected end of input"};
+    }
+    auto token = tokenizer->GetToken();
+    tokenizer->Next();
+    if (const auto* constant = std::get_if<ConstantToken>(&token)) {
+        return arena->Make<NumberNode>(constant->value);
+    } else if (const auto* bignum = std::get_if<BignumToken>(&token)) {
+        return arena->Make<BignumNode>(arena->MakeString(bignum->digits));
+    } else if (auto* symbol = std::get_if<SymbolToken>(&token)) {
+        if (symbol->name == "#t" || symbol->name == "#f") {
+            return arena->Make<BooleanNode>(symbol->name == "#t");
+        }
+        return arena->Make<SymbolNode>(symbol->GetId());
+    } else if (std::holds_alternative<QuoteToken>(token)) {
+        auto* quoted = arena->Make<CellNode>(ReadObject(tokenizer, arena), nullptr);
+        auto* quote = arena->Make<SymbolNode>(symbol_id::kQuote);
+        return arena->Make<CellNode>(quote, quoted);
+    } else if (token == Token{BracketToken::OPEN}) {
+        return ReadList(tokenizer, arena);
+    } else {
+        throw SyntaxError{"Unexpected token"};
+    }
+}
+
+}  // namespace
+
+SyntaxTree ReadTree(Tokenizer* tokenizer) {
+    SyntaxTree tree;
+    tree.root = ReadObject(tokenizer, &tree.arena);
+    if (!tokenizer->IsEnd()) {
+        throw SyntaxError{"Unexpected token after expression"};
+    }
+    return tree;
+}
+
 std::shared_ptr<Object> Read(Tokenizer* tokenizer) {
-    throw std::runtime_error{"Not implemented"};
+    return ToObject(ReadTree(tokenizer).root);
 }
@@ -1,8 +1,14 @@
 #pragma once
 
+#include <ast.h>
 #include <object.h>
 #include <tokenizer.h>
 
 #include <memory>
 
+// Читает ровно одно выражение, после которого поток токенов должен закончиться.
+// Пустой список представлен nullptr, #t и #f - объектами Boolean, 'x раскрывается в (quote x).
 std::shared_ptr<Object> Read(Tokenizer* tokenizer);
+
+// То же, но все узлы лежат в арене, которую возвращаемое дерево держит у себя.
+SyntaxTree ReadTree(Tokenizer* tokenizer);
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <value.h>
+#include <bytecode.h>
+
+#include <span>
+#include <string_view>
+
+class Heap;
+
+using BuiltinFunction = Value (*)(Heap* heap, std::span<const Value> args);
+
+struct Builtin : HeapObject {
+    static constexpr auto kType = ObjectType::kBuiltin;
+
+    Builtin(std::string_view name, BuiltinFunction function)
+        : HeapObject{kType}, name{name}, function{function} {
+    }
+
+    std::string_view name;
+    BuiltinFunction function;
+};
+
+struct Closure : HeapObject {
+    static constexpr auto kType = ObjectType::kClosure;
+
+    Closure(Code* code, Environment* env) : HeapObject{kType}, code{code}, env{env} {
+    }
+
+    Code* code;
+    Environment* env;
+};
@@ -0,0 +1,73 @@
+#include <profiler.h>
+
+#include <algorithm>
+
+void Profiler::Enter(std::string_view name) {
+    auto it = counters_.find(name);
+    if (it == counters_.end()) {
+        it = counters_.emplace(name, Counters{}).first;
+        it->second.entry.name = name;
+    }
+    auto& counters = it->second;
+    ++counters.entry.calls;
+    ++counters.depth;
+    auto& site = counters.sites[frames_.empty() ? nullptr : frames_.back().counters];
+    ++site.calls;
+    frames_.push_back({&counters, &site, std::chrono::steady_clock::now()});
+}
+
+void Profiler::Exit() {
+    if (frames_.empty()) {
+        return;
+    }
+    auto frame = frames_.back();
+    frames_.pop_back();
+
+    auto elapsed = std::chrono::steady_clock::now() - frame.start;
+    auto& entry = frame.counters->entry;
+    entry.exclusive_time += elapsed - frame.children;
+    if (--frame.counters->depth == 0) {
+        entry.inclusive_time += elapsed;
+    }
+    if (!frames_.empty()) {
+        frames_.back().children += elapsed;
+    }
+}
+
+void Profiler::OnAllocate(size_t bytes) {
+    if (!frames_.empty()) {
+        auto& frame = frames_.back();
+        frame.counters->entry.bytes_allocated += bytes;
+        frame.site->bytes_allocated += bytes;
+    }
+}
+
+void Profiler::Unwind() {
+    while (!frames_.empty()) {
+        Exit();
+    }
+}
+
+std::vector<ProfileEntry> Profiler::GetReport() const {
+    std::vector<ProfileEntry> report;
+    for (const auto& [name, counters] : counters_) {
+        auto& entry = report.emplace_back(counters.entry);
+        for (const auto& [caller, site] : counters.sites) {
+            auto caller_name = caller ? std::string_view{caller->entry.name} : kTopLevelCaller;
+            entry.callers.push_back({std::string{caller_name}, site.calls, site.bytes_allocated});
+        }
+        std::sort(entry.callers.begin(), entry.callers.end(),
+                  [](const CallSite& lhs, const CallSite& rhs) {
+                      return lhs.bytes_allocated > rhs.bytes_allocated;
+                  });
+    }
+    std::sort(report.begin(), report.end(), [](const ProfileEntry& lhs, const ProfileEntry& rhs) {
+        return lhs.exclusive_time > rhs.exclusive_time;
+    });
+    return report;
+}
+
+void Profiler::Reset() {
+    frames_.clear();
+    counters_.clear();
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Вызовы функции из одной вызывающей функции и байты, выделенные в этих вызовах.
+struct CallSite {
+    std::string caller;
+    size_t calls = 0;
+    size_t bytes_allocated = 0;
+};
+
+struct ProfileEntry {
+    std::string name;
+    size_t calls = 0;
+    // Время с учетом вложенных вызовов; рекурсивные вызовы не учитываются дважды.
+    std::chrono::nanoseconds inclusive_time{};
+    std::chrono::nanoseconds exclusive_time{};
+    // Байты, выделенные в куче, пока функция была на вершине стека вызовов.
+    size_t bytes_allocated = 0;
+    // То же по местам вызова, по убыванию выделенных байт. Вызовы из кода верхнего
+    // уровня записаны под именем kTopLevelCaller.
+    std::vector<CallSite> callers;
+};
+
+constexpr std::string_view kTopLevelCaller = "<top-level>";
+
+// Считает вызовы, время и выделения памяти по именам функций. Машина и куча сообщают
+// о событиях, только если профилировщик к ним подключен, так что без него цена -
+// одна проверка указателя на вызов и на выделение.
+class Profiler {
+public:
+    void Enter(std::string_view name);
+    void Exit();
+    void OnAllocate(size_t bytes);
+
+    // Закрывает вызовы, прерванные исключением.
+    void Unwind();
+
+    // Отсортировано по убыванию собственного времени.
+    std::vector<ProfileEntry> GetReport() const;
+    void Reset();
+
+private:
+    struct SiteCounters {
+        size_t calls = 0;
+        size_t bytes_allocated = 0;
+    };
+
+    struct Counters {
+        ProfileEntry entry;
+        size_t depth = 0;
+        // nullptr - верхний уровень.
+        std::unordered_map<const Counters*, SiteCounters> sites;
+    };
+
+    struct Frame {
+        Counters* counters;
+        // Узлы unordered_map не переезжают, поэтому счетчики места вызова находятся один
+        // раз при входе, а не при каждом выделении.
+        SiteCounters* site;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::nanoseconds children{};
+    };
+
+    struct NameHash {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view name) const {
+            return std::hash<std::string_view>{}(name);
+        }
+    };
+
+    std::unordered_map<std::string, Counters, NameHash, std::equal_to<>> counters_;
+    std::vector<Frame> frames_;
+};
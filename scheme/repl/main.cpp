@@ -1,8 +1,28 @@
 #include <scheme.h>
+#include <fstream>
 #include <iostream>
+#include <string_view>
 
-int main() {
+// scheme-repl [--image FILE] [--save-image FILE]: загрузить образ при старте,
+// сохранить образ глобального окружения при выходе.
+int main(int argc, char* argv[]) {
     Scheme scheme;
+    const char* save_path = nullptr;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string_view option = argv[i];
+        if (option == "--image") {
+            std::ifstream in{argv[i + 1], std::ios::binary};
+            try {
+                scheme.LoadImage(in);
+            } catch (const std::runtime_error& ex) {
+                std::cerr << argv[i + 1] << ": " << ex.what() << '\n';
+                return 1;
+            }
+        } else if (option == "--save-image") {
+            save_path = argv[i + 1];
+        }
+    }
+
     std::string expression;
     std::cout << "Scheme 1.0.0\n";
     while (std::cin) {
@@ -18,4 +38,9 @@ int main() {
         }
         std::cout << '\n';
     }
+
+    if (save_path) {
+        std::ofstream out{save_path, std::ios::binary};
+        scheme.SaveImage(out);
+    }
 }
@@ -1,8 +1,80 @@
 #include <scheme.h>
+#include <builtins.h>
+#include <heap_image.h>
+#include <parser.h>
+#include <tokenizer.h>
 
-#include <stdexcept>
+#include <iterator>
 #include <string>
+#include <string_view>
+#include <utility>
+
+Scheme::Scheme() : globals_{&heap_}, compiler_{&heap_, &globals_}, vm_{&heap_, &globals_} {
+    RegisterBuiltins(&heap_, &globals_);
+}
+
+Scheme::Scheme(std::shared_ptr<const Prelude> prelude)
+    : prelude_{std::move(prelude)},
+      globals_{&heap_, prelude_->scheme_.globals_},
+      compiler_{&heap_, &globals_},
+      vm_{&heap_, &globals_} {
+}
 
 std::string Scheme::Evaluate(const std::string& expression) {
-    throw std::runtime_error{"Not implemented"};
+    Tokenizer tokenizer{std::string_view{expression}};
+    auto tree = ReadTree(&tokenizer);
+    auto* code = compiler_.Compile(tree.root);
+    return ToString(vm_.Run(code));
+}
+
+void Scheme::SetGcThreshold(size_t bytes) {
+    heap_.SetCollectionThreshold(bytes);
+}
+
+void Scheme::CollectGarbage() {
+    heap_.Collect();
+}
+
+const GcStats& Scheme::GetGcStats() const {
+    return heap_.GetStats();
+}
+
+void Scheme::SetIncrementalGc(bool incremental, size_t budget) {
+    heap_.SetIncremental(incremental);
+    heap_.SetIncrementBudget(budget);
+}
+
+void Scheme::SetRecursionLimit(size_t depth) {
+    vm_.SetMaxDepth(depth);
+}
+
+void Scheme::EnableProfiling(bool enable) {
+    auto* profiler = enable ? &profiler_ : nullptr;
+    heap_.SetProfiler(profiler);
+    vm_.SetProfiler(profiler);
+}
+
+std::vector<ProfileEntry> Scheme::GetProfileReport() const {
+    return profiler_.GetReport();
+}
+
+void Scheme::ResetProfile() {
+    profiler_.Reset();
+}
+
+void Scheme::SaveImage(std::ostream& out) const {
+    auto image = WriteImage(globals_);
+    out.write(image.data(), static_cast<std::streamsize>(image.size()));
+}
+
+void Scheme::LoadImage(std::istream& in) {
+    std::string image{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+    ReadImage(image, &heap_, &globals_);
+}
+
+Prelude::Prelude(const std::vector<std::string>& definitions) {
+    for (const auto& definition : definitions) {
+        scheme_.Evaluate(definition);
+    }
+    scheme_.heap_.Freeze();
 }
@@ -1,8 +1,74 @@
 #pragma once
 
+#include <heap.h>
+#include <globals.h>
+#include <compiler.h>
+#include <vm.h>
+#include <profiler.h>
+
+#include <cstddef>
+#include <istream>
+#include <memory>
+#include <ostream>
 #include <string>
+#include <vector>
+
+class Prelude;
 
 class Scheme {
 public:
+    Scheme();
+
+    // Интерпретатор поверх общей прелюдии: встроенные функции и ее определения не создаются
+    // заново, свои у него только новые объекты и таблица глобальных переменных.
+    explicit Scheme(std::shared_ptr<const Prelude> prelude);
+
     std::string Evaluate(const std::string& expression);
+
+    // Сборка запускается, когда с прошлой сборки выделено больше bytes байт.
+    void SetGcThreshold(size_t bytes);
+    void CollectGarbage();
+    const GcStats& GetGcStats() const;
+
+    // Инкрементальная сборка короткими паузами, см. Heap; budget - работа одной паузы.
+    void SetIncrementalGc(bool incremental, size_t budget = Heap::kDefaultIncrementBudget);
+
+    // Ограничение глубины нехвостовых вызовов, при превышении - RuntimeError.
+    void SetRecursionLimit(size_t depth);
+
+    // Профилирование вызовов; результат доступен и из программы через (profile-report).
+    void EnableProfiling(bool enable);
+    std::vector<ProfileEntry> GetProfileReport() const;
+    void ResetProfile();
+
+    // Образ глобального окружения (см. heap_image.h): прелюдию достаточно вычислить один раз,
+    // дальше интерпретатор загружает сохраненный образ вместо ее повторного вычисления.
+    void SaveImage(std::ostream& out) const;
+    void LoadImage(std::istream& in);
+
+private:
+    friend class Prelude;
+
+    // Объявлена первой, чтобы объекты прелюдии пережили все ссылки на них.
+    std::shared_ptr<const Prelude> prelude_;
+    Profiler profiler_;
+    Heap heap_;
+    Globals globals_;
+    Compiler compiler_;
+    VirtualMachine vm_;
+};
+
+// Встроенные функции и определения, вычисленные один раз и замороженные (см. Heap::Freeze).
+// Интерпретаторы поверх прелюдии разделяют ее объекты только для чтения, в том числе
+// из разных потоков, а define и set! глобальных переменных видны только в своем
+// интерпретаторе. Изменить сам объект прелюдии, например set-car! на ее списке или set!
+// переменной, захваченной ее замыканием, - RuntimeError.
+class Prelude {
+public:
+    explicit Prelude(const std::vector<std::string>& definitions = {});
+
+private:
+    friend class Scheme;
+
+    Scheme scheme_;
 };
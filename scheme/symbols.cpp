@@ -0,0 +1,44 @@
+#include <symbols.h>
+
+#include <mutex>
+
+namespace {
+
+// В порядке номеров из symbol_id.
+constexpr std::string_view kReservedNames[] = {"quote",  "if",    "define", "set!",
+                                               "lambda", "begin", "and",    "or"};
+
+}  // namespace
+
+SymbolTable::SymbolTable() {
+    for (auto name : kReservedNames) {
+        Intern(name);
+    }
+}
+
+SymbolTable& SymbolTable::Instance() {
+    static SymbolTable table;
+    return table;
+}
+
+// Почти все имена уже известны, поэтому сначала ищем под разделяемой блокировкой.
+uint32_t SymbolTable::Intern(std::string_view name) {
+    {
+        std::shared_lock lock{mutex_};
+        if (auto it = ids_.find(name); it != ids_.end()) {
+            return it->second;
+        }
+    }
+    std::unique_lock lock{mutex_};
+    if (auto it = ids_.find(name); it != ids_.end()) {
+        return it->second;
+    }
+    auto id = static_cast<uint32_t>(names_.size());
+    ids_.emplace(names_.emplace_back(name), id);
+    return id;
+}
+
+const std::string& SymbolTable::GetName(uint32_t id) const {
+    std::shared_lock lock{mutex_};
+    return names_[id];
+}
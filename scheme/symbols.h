@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// Имена, которые нужны самому интерпретатору, получают фиксированные номера.
+namespace symbol_id {
+
+constexpr uint32_t kQuote = 0;
+constexpr uint32_t kIf = 1;
+constexpr uint32_t kDefine = 2;
+constexpr uint32_t kSet = 3;
+constexpr uint32_t kLambda = 4;
+constexpr uint32_t kBegin = 5;
+constexpr uint32_t kAnd = 6;
+constexpr uint32_t kOr = 7;
+
+}  // namespace symbol_id
+
+// Таблица имен символов. Символ везде после токенизатора - просто номер в ней,
+// поэтому сравнение символов сводится к сравнению чисел. Имена живут до конца программы,
+// ссылки на них не инвалидируются. Читать и пополнять таблицу можно из разных потоков.
+class SymbolTable {
+public:
+    static SymbolTable& Instance();
+
+    uint32_t Intern(std::string_view name);
+    const std::string& GetName(uint32_t id) const;
+
+private:
+    SymbolTable();
+
+    mutable std::shared_mutex mutex_;
+    std::deque<std::string> names_;
+    std::unordered_map<std::string_view, uint32_t> ids_;
+};
@@ -0,0 +1,76 @@
+#include <tests/scheme_test.h>
+
+TEST_CASE_METHOD(SchemeTest, "BignumPromotion") {
+    ExpectNoError("(define big (* 1073741824 1073741824 4))");
+    ExpectEq("big", "4611686018427387904");
+    ExpectEq("(- big 1)", "4611686018427387903");
+    ExpectEq("(- 0 big)", "-4611686018427387904");
+    ExpectEq("(/ (- 0 big) -1)", "4611686018427387904");
+    ExpectEq("(* big 4)", "18446744073709551616");
+    ExpectEq("(- (* big big) (* big big) 7)", "-7");
+    ExpectEq("(number? big)", "#t");
+    ExpectEq("(abs (- 0 big big))", "9223372036854775808");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BignumFactorial") {
+    ExpectNoError("(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))");
+    ExpectEq("(fact 20)", "2432902008176640000");
+    ExpectEq("(fact 30)", "265252859812191058636308480000000");
+    ExpectEq("(/ (fact 30) (fact 28))", "870");
+    ExpectEq("(/ (fact 30) (- 0 (fact 29)))", "-30");
+    ExpectEq("(/ (fact 29) (fact 30))", "0");
+    ExpectRuntimeError("(/ (fact 30) 0)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "BignumComparison") {
+    ExpectNoError("(define (pow x n) (if (= n 0) 1 (* x (pow x (- n 1)))))");
+    ExpectEq("(pow 2 200)",
+             "1606938044258990275541962092341162602522202993782792835301376");
+    ExpectEq("(< (pow 2 100) (pow 2 101) (pow 3 100))", "#t");
+    ExpectEq("(< (- 0 (pow 2 101)) (- 0 (pow 2 100)) 0 1 (pow 2 100))", "#t");
+    ExpectEq("(= (pow 2 100) (* (pow 2 50) (pow 2 50)))", "#t");
+    ExpectEq("(max 1 (pow 2 70) (pow 2 64))", "1180591620717411303424");
+    ExpectEq("(min 1 (- 0 (pow 2 64)))", "-18446744073709551616");
+}
+
+// Большие множители умножаются по Карацубе, степени по одному разряду - в столбик.
+TEST_CASE_METHOD(SchemeTest, "BignumKaratsuba") {
+    ExpectNoError("(define (pow x n) (if (= n 0) 1 (* x (pow x (- n 1)))))");
+    ExpectNoError("(define a (pow 3 2000))");
+    ExpectNoError("(define b (pow 7 1500))");
+    ExpectEq("(= (* a a) (pow 3 4000))", "#t");
+    ExpectEq("(= (* a (pow 3 300)) (pow 3 2300))", "#t");
+    ExpectEq("(= (/ (* a b) a) b)", "#t");
+    ExpectEq("(= (/ (* a b) b) a)", "#t");
+    ExpectEq("(- (* a b) (* b a))", "0");
+    ExpectEq("(/ (+ (* a b) 1) (* b a))", "1");
+}
+
+// Литералы до int64_t читаются как есть, длиннее - разбираются в Bignum.
+TEST_CASE_METHOD(SchemeTest, "NumberLiterals") {
+    ExpectEq("2147483648", "2147483648");
+    ExpectEq("4611686018427387903", "4611686018427387903");
+    ExpectEq("4611686018427387904", "4611686018427387904");
+    ExpectEq("-4611686018427387905", "-4611686018427387905");
+    ExpectEq("9223372036854775807", "9223372036854775807");
+    ExpectEq("-9223372036854775808", "-9223372036854775808");
+    ExpectEq("9223372036854775808", "9223372036854775808");
+    ExpectEq("-9223372036854775809", "-9223372036854775809");
+    ExpectEq("-12345678901234567890", "-12345678901234567890");
+    ExpectEq("+18446744073709551616", "18446744073709551616");
+    ExpectEq("000000000000000000000000000042", "42");
+    ExpectEq("-00000000000000000000000000000", "0");
+
+    ExpectEq("(+ 123456789012345678901234567890 1)", "123456789012345678901234567891");
+    ExpectEq("(- 100000000000000000000 99999999999999999999)", "1");
+    ExpectEq("(= 4611686018427387904 (* 1073741824 1073741824 4))", "#t");
+    ExpectEq("(* 1180591620717411303424 -1)", "-1180591620717411303424");
+    ExpectEq("'(1 99999999999999999999 -99999999999999999999)",
+             "(1 99999999999999999999 -99999999999999999999)");
+
+    ExpectNoError("(define (pow x n) (if (= n 0) 1 (* x (pow x (- n 1)))))");
+    ExpectEq("(= (pow 2 200) "
+             "1606938044258990275541962092341162602522202993782792835301376)",
+             "#t");
+    ExpectEq("(= (- 0 (pow 3 100)) -515377520732011331036461129765621272702107522001)", "#t");
+}
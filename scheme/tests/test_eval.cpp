@@ -6,3 +6,15 @@ TEST_CASE_METHOD(SchemeTest, "Quote") {
     ExpectEq("'101", "101");
     ExpectEq("(quote (-2 . 3))", "(-2 . 3)");
 }
+
+TEST_CASE_METHOD(SchemeTest, "RedefinedBuiltinsAreCalled") {
+    ExpectNoError("(define (add3 x) (+ x 3))");
+    ExpectEq("(add3 1)", "4");
+
+    ExpectNoError("(define + -)");
+    ExpectEq("(+ 5 3)", "2");
+    ExpectEq("(add3 1)", "-2");
+
+    ExpectNoError("(define (f car) (car 1))");
+    ExpectEq("(f (lambda (x) (* x 10)))", "10");
+}
@@ -0,0 +1,130 @@
+#include <tests/scheme_test.h>
+#include <hash_table.h>
+
+TEST_CASE("GarbageIsCollected") {
+    Scheme scheme;
+    scheme.SetGcThreshold(1 << 12);
+
+    scheme.Evaluate("(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))");
+    scheme.Evaluate("(define (loop i) (if (= i 0) 0 (begin ((make-counter)) (loop (- i 1)))))");
+    REQUIRE(scheme.Evaluate("(loop 10000)") == "0");
+
+    const auto& stats = scheme.GetGcStats();
+    REQUIRE(stats.collections > 0);
+    REQUIRE(stats.bytes_freed > 0);
+
+    scheme.CollectGarbage();
+    REQUIRE(stats.live_bytes < stats.bytes_allocated / 10);
+}
+
+TEST_CASE("ReachableValuesSurviveCollection") {
+    Scheme scheme;
+    scheme.SetGcThreshold(1);
+
+    scheme.Evaluate("(define x (list 1 2 3))");
+    scheme.Evaluate("(define (f) (cons x x))");
+    scheme.CollectGarbage();
+    REQUIRE(scheme.Evaluate("(f)") == "((1 2 3) 1 2 3)");
+
+    scheme.Evaluate("(define x '(a (b . c)))");
+    scheme.CollectGarbage();
+    REQUIRE(scheme.Evaluate("(car (f))") == "(a (b . c))");
+}
+
+TEST_CASE("ImmediatesDoNotAllocate") {
+    Scheme scheme;
+    scheme.Evaluate("(define x '(-2147483647 2147483647 #t #f sym))");
+    scheme.CollectGarbage();
+    const auto& stats = scheme.GetGcStats();
+    auto live = stats.live_bytes;
+
+    scheme.Evaluate("(set-car! x (+ (car x) 1))");
+    scheme.Evaluate("(set-car! (cdr (cdr (cdr (cdr x)))) 'other)");
+    scheme.CollectGarbage();
+    REQUIRE(stats.live_bytes == live);
+    REQUIRE(scheme.Evaluate("x") == "(-2147483646 2147483647 #t #f other)");
+    REQUIRE(scheme.Evaluate("(symbol? (car (cdr (cdr (cdr (cdr x))))))") == "#t");
+}
+
+TEST_CASE("IncrementalCollection") {
+    Scheme scheme;
+    scheme.SetGcThreshold(1 << 12);
+    scheme.SetIncrementalGc(true, 1);
+
+    scheme.Evaluate("(define (build n) (if (= n 0) '() (cons n (build (- n 1)))))");
+    scheme.Evaluate("(define (sum l) (if (null? l) 0 (+ (car l) (sum (cdr l)))))");
+    scheme.Evaluate("(define (make-box) (define x '()) (lambda (op v) (if op (set! x v) x)))");
+    scheme.Evaluate("(define a (cons (build 100) '()))");
+    scheme.Evaluate("(define b (cons '() '()))");
+    scheme.Evaluate("(define v (make-vector 1 '()))");
+    scheme.Evaluate("(define t (make-hash-table))");
+    scheme.Evaluate("(define box (make-box))");
+
+    // Список все время переезжает между объектами, и ссылка на него остается только в одном.
+    // Без барьера он рано или поздно оказался бы лишь в уже просмотренном объекте
+    // и был бы освобожден.
+    scheme.Evaluate(
+        "(define (churn i)"
+        "  (if (= i 0) (sum (car a))"
+        "      (begin (set-cdr! b (car a)) (set-car! a '()) (build 20)"
+        "             (vector-set! v 0 (cdr b)) (set-cdr! b '()) (build 20)"
+        "             (hash-set! t 'x (vector-ref v 0)) (vector-set! v 0 '()) (build 20)"
+        "             (box #t (hash-ref t 'x)) (hash-set! t 'x '()) (build 20)"
+        "             (set-car! a (box #f 0)) (box #t '())"
+        "             (churn (- i 1)))))");
+    REQUIRE(scheme.Evaluate("(churn 3000)") == "5050");
+
+    const auto& stats = scheme.GetGcStats();
+    REQUIRE(stats.collections > 0);
+    REQUIRE(stats.increments > 10 * stats.collections);
+    size_t pauses = 0;
+    for (auto count : stats.pause_histogram) {
+        pauses += count;
+    }
+    REQUIRE(pauses == stats.increments);
+
+    // Полная сборка посреди инкрементального цикла.
+    scheme.Evaluate("(churn 7)");
+    scheme.CollectGarbage();
+    REQUIRE(scheme.Evaluate("(churn 100)") == "5050");
+    scheme.CollectGarbage();
+    REQUIRE(stats.live_bytes < 1 << 16);
+}
+
+// Ячейки хеш-таблиц лежат вне кучи, но сборщик должен их учитывать: иначе таблица
+// на тысячи ключей выглядит для него как один мелкий объект.
+TEST_CASE("HashTableEntriesAreCounted") {
+    Scheme scheme;
+    scheme.SetGcThreshold(1 << 15);
+
+    // fill и probe делают одинаковые вызовы, но только fill наполняет таблицу.
+    scheme.Evaluate(
+        "(define (fill t i) (if (= i 0) t (begin (hash-set! t i i) (fill t (- i 1)))))");
+    scheme.Evaluate(
+        "(define (probe t i) (if (= i 0) t (begin (hash-ref t i 0) (probe t (- i 1)))))");
+    scheme.Evaluate("(define (loop f i) (if (= i 0) 0 (begin (f (make-hash-table) 1000) "
+                    "(loop f (- i 1)))))");
+    const auto& stats = scheme.GetGcStats();
+    auto allocated = stats.bytes_allocated;
+    auto collections = stats.collections;
+    REQUIRE(scheme.Evaluate("(loop probe 100)") == "0");
+    auto probe_allocated = stats.bytes_allocated - allocated;
+    auto probe_collections = stats.collections - collections;
+    allocated = stats.bytes_allocated;
+    collections = stats.collections;
+    REQUIRE(scheme.Evaluate("(loop fill 100)") == "0");
+    // Таблица на 1000 ключей растет от 8 до 2048 ячеек.
+    REQUIRE(stats.bytes_allocated - allocated - probe_allocated >=
+            100 * (4096 - 8) * sizeof(HashTable::Entry));
+    // Сборщик видит эти байты и запускается соответственно чаще.
+    REQUIRE(2 * (stats.collections - collections) > 3 * probe_collections);
+
+    scheme.CollectGarbage();
+    auto live = stats.live_bytes;
+    scheme.Evaluate("(define t (fill (make-hash-table) 1000))");
+    scheme.CollectGarbage();
+    REQUIRE(stats.live_bytes >= live + 2048 * sizeof(HashTable::Entry));
+    scheme.Evaluate("(define t 0)");
+    scheme.CollectGarbage();
+    REQUIRE(stats.live_bytes <= live);
+}
@@ -0,0 +1,118 @@
+#include <tests/scheme_test.h>
+
+#include <sstream>
+
+namespace {
+
+std::string SaveImage(const Scheme& scheme) {
+    std::ostringstream out;
+    scheme.SaveImage(out);
+    return out.str();
+}
+
+void LoadImage(Scheme* scheme, const std::string& image) {
+    std::istringstream in{image};
+    scheme->LoadImage(in);
+}
+
+}  // namespace
+
+TEST_CASE("ImageRestoresGlobals") {
+    Scheme prelude;
+    prelude.Evaluate("(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))");
+    prelude.Evaluate("(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))");
+    prelude.Evaluate("(define counter (make-counter))");
+    prelude.Evaluate("(counter)");
+    prelude.Evaluate("(define data '(a (b . c) #t -7))");
+    prelude.Evaluate("(define big (fact 25))");
+    prelude.Evaluate("(define cycle (list 1 2))");
+    prelude.Evaluate("(set-cdr! (cdr cycle) cycle)");
+    prelude.Evaluate("(define table (make-hash-table))");
+    prelude.Evaluate("(hash-set! table 'key (vector 1 'a data))");
+    prelude.Evaluate("(hash-set! table 42 table)");
+    prelude.Evaluate("(define car cdr)");
+    auto image = SaveImage(prelude);
+
+    Scheme scheme;
+    LoadImage(&scheme, image);
+    REQUIRE(scheme.Evaluate("(fact 10)") == "3628800");
+    REQUIRE(scheme.Evaluate("(counter)") == "2");
+    REQUIRE(scheme.Evaluate("(counter)") == "3");
+    REQUIRE(prelude.Evaluate("(counter)") == "2");
+    REQUIRE(scheme.Evaluate("data") == "(a (b . c) #t -7)");
+    REQUIRE(scheme.Evaluate("big") == "15511210043330985984000000");
+    REQUIRE(scheme.Evaluate("(list-ref cycle 5)") == "2");
+    REQUIRE(scheme.Evaluate("(hash-ref table 'key)") == "#(1 a (a (b . c) #t -7))");
+    REQUIRE(scheme.Evaluate("(hash-count (hash-ref table 42))") == "2");
+    REQUIRE(scheme.Evaluate("(car '(1 2))") == "(2)");
+    REQUIRE(scheme.Evaluate("(cdr '(1 2))") == "(2)");
+
+    Scheme copy;
+    LoadImage(&copy, SaveImage(scheme));
+    REQUIRE(copy.Evaluate("(counter)") == "4");
+}
+
+TEST_CASE("ImageSurvivesCollection") {
+    Scheme prelude;
+    prelude.Evaluate("(define (adder n) (lambda (x) (+ x n)))");
+    prelude.Evaluate("(define add5 (adder 5))");
+    auto image = SaveImage(prelude);
+
+    Scheme scheme;
+    scheme.SetGcThreshold(1);
+    LoadImage(&scheme, image);
+    scheme.CollectGarbage();
+    REQUIRE(scheme.Evaluate("(add5 (add5 1))") == "11");
+    REQUIRE(scheme.Evaluate("((adder 2) 3)") == "5");
+}
+
+TEST_CASE("InvalidImage") {
+    Scheme prelude;
+    prelude.Evaluate("(define x '(1 2 3))");
+    auto image = SaveImage(prelude);
+
+    Scheme scheme;
+    REQUIRE_THROWS_AS(LoadImage(&scheme, ""), RuntimeError);
+    REQUIRE_THROWS_AS(LoadImage(&scheme, "not an image"), RuntimeError);
+    for (size_t size = 0; size < image.size(); ++size) {
+        REQUIRE_THROWS_AS(LoadImage(&scheme, image.substr(0, size)), RuntimeError);
+    }
+    REQUIRE_THROWS_AS(scheme.Evaluate("x"), NameError);
+}
+
+TEST_CASE("CorruptedImage") {
+    // Только числа и функции без циклов: испорченный образ может поменять константы
+    // и переходы, но не должен зацикливать вычисление или его печать.
+    Scheme prelude;
+    prelude.Evaluate("(define (adder n) (lambda (x) (if (< x 0) (- x n) (+ x n))))");
+    prelude.Evaluate("(define (pick a b) (and (> a 0) (or (= b 1) (* a b 123456789))))");
+    prelude.Evaluate(
+        "(define (nested a) (define b (+ a 1)) ((lambda (c) (set! b c) (cons a b)) 7))");
+    prelude.Evaluate("(define add5 (adder 5))");
+    prelude.Evaluate("(define big (* 1073741824 1073741824 1073741824))");
+    auto image = SaveImage(prelude);
+
+    auto loaded = 0;
+    for (size_t i = 0; i < image.size(); ++i) {
+        for (auto mask : {0x01, 0x02, 0x10, 0x80}) {
+            auto corrupted = image;
+            corrupted[i] = static_cast<char>(corrupted[i] ^ mask);
+            Scheme scheme;
+            try {
+                LoadImage(&scheme, corrupted);
+            } catch (const RuntimeError&) {
+                continue;
+            }
+            ++loaded;
+            for (auto expression : {"(add5 1)", "((adder 2) -3)", "(pick 2 3)", "(nested 1)",
+                                    "big"}) {
+                try {
+                    scheme.Evaluate(expression);
+                } catch (const std::runtime_error&) {
+                }
+            }
+        }
+    }
+    // Часть порчи безвредна (например, другая константа), такие образы загружаются.
+    REQUIRE(loaded > 0);
+}
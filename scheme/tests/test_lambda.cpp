@@ -62,3 +62,40 @@ TEST_CASE_METHOD(SchemeTest, "DefineLambdaSugar") {
     ExpectEq("(f)", "32");
     ExpectEq("(f)", "32");
 }
+
+TEST_CASE_METHOD(SchemeTest, "VariadicLambda") {
+    ExpectEq("((lambda x x) 1 2 3)", "(1 2 3)");
+    ExpectEq("((lambda (x . y) y) 1 2 3)", "(2 3)");
+    ExpectEq("((lambda (x . y) y) 1)", "()");
+    ExpectRuntimeError("((lambda (x . y) y))");
+    ExpectRuntimeError("((lambda (x) x) 1 2)");
+}
+
+// С ограничением в 100 вызовов циклы на 10^5 итераций проходят, только если хвостовые
+// вызовы не растят стек.
+TEST_CASE("TailCalls") {
+    Scheme scheme;
+    scheme.SetRecursionLimit(100);
+
+    scheme.Evaluate("(define (loop i acc) (if (= i 0) acc (loop (- i 1) (+ acc 1))))");
+    REQUIRE(scheme.Evaluate("(loop 100000 0)") == "100000");
+
+    scheme.Evaluate("(define (even? n) (if (= n 0) #t (odd? (- n 1))))");
+    scheme.Evaluate("(define (odd? n) (and (not (= n 0)) (even? (- n 1))))");
+    REQUIRE(scheme.Evaluate("(even? 100001)") == "#f");
+
+    scheme.Evaluate("(define (count n) (begin (define m (- n 1)) (or (= m 0) (count m))))");
+    REQUIRE(scheme.Evaluate("(count 100000)") == "#t");
+}
+
+TEST_CASE("RecursionLimit") {
+    Scheme scheme;
+    scheme.SetRecursionLimit(100);
+    scheme.Evaluate("(define (sum n) (if (= n 0) 0 (+ n (sum (- n 1)))))");
+    REQUIRE(scheme.Evaluate("(sum 90)") == "4095");
+    REQUIRE_THROWS_AS(scheme.Evaluate("(sum 200)"), RuntimeError);
+    REQUIRE(scheme.Evaluate("(sum 10)") == "55");
+
+    scheme.Evaluate("(define (forever n) (+ 1 (forever n)))");
+    REQUIRE_THROWS_AS(scheme.Evaluate("(forever 0)"), RuntimeError);
+}
@@ -0,0 +1,47 @@
+#include <parser.h>
+#include <error.h>
+
+#include <string>
+
+#include <catch2/catch_test_macros.hpp>
+
+TEST_CASE("ArenaTreeMatchesObjectTree") {
+    const std::string source = "(define (f . x) '(1 #t (a . b) ()) (g -5))";
+    Tokenizer tokenizer{std::string_view{source}};
+    auto tree = ReadTree(&tokenizer);
+    REQUIRE(ToString(ToObject(tree.root)) == "(define (f . x) (quote (1 #t (a . b) ())) (g -5))");
+
+    const auto* cell = As<CellNode>(tree.root);
+    REQUIRE(cell);
+    REQUIRE(As<SymbolNode>(cell->first));
+    REQUIRE(tree.arena.GetBytesAllocated() > 0);
+}
+
+TEST_CASE("ArenaTreeNumbers") {
+    const std::string source = "(4294967296 -18446744073709551616)";
+    Tokenizer tokenizer{std::string_view{source}};
+    auto tree = ReadTree(&tokenizer);
+
+    const auto* cell = As<CellNode>(tree.root);
+    REQUIRE(As<NumberNode>(cell->first)->value == 4294967296);
+    const auto* bignum = As<BignumNode>(As<CellNode>(cell->second)->first);
+    REQUIRE(bignum);
+    REQUIRE(bignum->digits == "-18446744073709551616");
+    REQUIRE_THROWS_AS(ToObject(tree.root), SyntaxError);
+}
+
+TEST_CASE("ArenaTreeOfLongList") {
+    std::string source = "(";
+    for (auto i = 0; i < 100000; ++i) {
+        source += "x ";
+    }
+    source += ")";
+    Tokenizer tokenizer{std::string_view{source}};
+    auto tree = ReadTree(&tokenizer);
+
+    size_t length = 0;
+    for (const auto* node = tree.root; node; node = As<CellNode>(node)->second) {
+        ++length;
+    }
+    REQUIRE(length == 100000);
+}
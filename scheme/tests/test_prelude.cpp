@@ -0,0 +1,96 @@
+#include <tests/scheme_test.h>
+
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+std::shared_ptr<const Prelude> MakePrelude() {
+    return std::make_shared<const Prelude>(std::vector<std::string>{
+        "(define (fact n) (if (= n 0) 1 (* n (fact (- n 1)))))",
+        "(define (map f xs) (if (null? xs) '() (cons (f (car xs)) (map f (cdr xs)))))",
+        "(define squares (map (lambda (x) (* x x)) '(1 2 3 4)))",
+        "(define table (make-hash-table))",
+        "(hash-set! table 'answer 42)",
+        "(define (make-counter) (define n 0) (lambda () (set! n (+ n 1)) n))",
+        "(define counter (make-counter))",
+    });
+}
+
+}  // namespace
+
+TEST_CASE("PreludeIsShared") {
+    auto prelude = MakePrelude();
+    Scheme first{prelude};
+    Scheme second{prelude};
+
+    // Встроенные функции и определения прелюдии не копируются в кучу интерпретатора.
+    REQUIRE(first.GetGcStats().bytes_allocated == 0);
+
+    REQUIRE(first.Evaluate("(fact 20)") == "2432902008176640000");
+    REQUIRE(first.Evaluate("(map fact squares)") == "(1 24 362880 20922789888000)");
+    REQUIRE(first.Evaluate("(hash-ref table 'answer)") == "42");
+
+    first.Evaluate("(define x 1)");
+    first.Evaluate("(set! squares (cdr squares))");
+    first.Evaluate("(define (fact n) n)");
+    REQUIRE(first.Evaluate("squares") == "(4 9 16)");
+    REQUIRE(first.Evaluate("(map fact '(5))") == "(5)");
+    first.Evaluate("(define car cdr)");
+    REQUIRE(first.Evaluate("(car '(1 2))") == "(2)");
+
+    REQUIRE_THROWS_AS(second.Evaluate("x"), NameError);
+    REQUIRE(second.Evaluate("squares") == "(1 4 9 16)");
+    REQUIRE(second.Evaluate("(map fact '(5))") == "(120)");
+    REQUIRE(second.Evaluate("(car '(1 2))") == "1");
+
+    Scheme third{prelude};
+    REQUIRE(third.Evaluate("(fact 5)") == "120");
+}
+
+TEST_CASE("PreludeIsImmutable") {
+    Scheme scheme{MakePrelude()};
+    REQUIRE_THROWS_AS(scheme.Evaluate("(set-car! squares 0)"), RuntimeError);
+    REQUIRE_THROWS_AS(scheme.Evaluate("(set-cdr! squares '())"), RuntimeError);
+    REQUIRE_THROWS_AS(scheme.Evaluate("(hash-set! table 'answer 0)"), RuntimeError);
+    REQUIRE_THROWS_AS(scheme.Evaluate("(counter)"), RuntimeError);
+    REQUIRE(scheme.Evaluate("squares") == "(1 4 9 16)");
+    REQUIRE(scheme.Evaluate("(hash-ref table 'answer)") == "42");
+
+    // Собственные объекты, в том числе созданные функциями прелюдии, менять можно.
+    scheme.Evaluate("(define own (map fact '(1 2 3)))");
+    scheme.Evaluate("(set-car! own 0)");
+    REQUIRE(scheme.Evaluate("own") == "(0 2 6)");
+    scheme.Evaluate("(define own-counter (make-counter))");
+    scheme.Evaluate("(own-counter)");
+    REQUIRE(scheme.Evaluate("(own-counter)") == "2");
+}
+
+TEST_CASE("PreludeAcrossThreads") {
+    auto prelude = MakePrelude();
+    constexpr int kThreads = 8;
+    std::vector<std::string> results(kThreads);
+    std::vector<std::thread> threads;
+    for (int i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&prelude, &results, i] {
+            Scheme scheme{prelude};
+            scheme.SetGcThreshold(1 << 10);
+            scheme.SetIncrementalGc(i % 2 == 0, 16);
+            scheme.Evaluate(
+                "(define (loop k acc) (if (= k 0) acc (loop (- k 1) (map fact squares))))");
+            scheme.Evaluate("(define own (list " + std::to_string(i) + "))");
+            results[i] = scheme.Evaluate("(cons (car own) (loop 2000 '()))");
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (int i = 0; i < kThreads; ++i) {
+        std::string expected = "(";
+        expected += std::to_string(i);
+        expected += " 1 24 362880 20922789888000)";
+        REQUIRE(results[i] == expected);
+    }
+}
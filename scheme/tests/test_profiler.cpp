@@ -0,0 +1,108 @@
+#include <scheme.h>
+#include <error.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+const ProfileEntry* Find(const std::vector<ProfileEntry>& report, const std::string& name) {
+    auto it = std::find_if(report.begin(), report.end(),
+                           [&name](const ProfileEntry& entry) { return entry.name == name; });
+    return it == report.end() ? nullptr : &*it;
+}
+
+}  // namespace
+
+TEST_CASE("ProfilerCountsCalls") {
+    Scheme scheme;
+    scheme.Evaluate("(define (fib n) (if (< n 2) n (+ (fib (- n 1)) (fib (- n 2)))))");
+    scheme.Evaluate("(define (pairs n) (if (= n 0) '() (cons (list n n) (pairs (- n 1)))))");
+    scheme.Evaluate("(fib 5)");
+    REQUIRE(scheme.GetProfileReport().empty());
+
+    scheme.EnableProfiling(true);
+    REQUIRE(scheme.Evaluate("(fib 10)") == "55");
+    REQUIRE(scheme.Evaluate("(car (pairs 100))") == "(100 100)");
+    auto report = scheme.GetProfileReport();
+
+    const auto* fib = Find(report, "fib");
+    REQUIRE(fib);
+    REQUIRE(fib->calls == 177);
+    REQUIRE(fib->bytes_allocated > 0);
+    REQUIRE(fib->inclusive_time >= fib->exclusive_time);
+
+    const auto* list = Find(report, "list");
+    REQUIRE(list);
+    REQUIRE(list->calls == 100);
+    REQUIRE(list->bytes_allocated > 0);
+    REQUIRE(Find(report, "pairs")->calls == 101);
+
+    for (size_t i = 1; i < report.size(); ++i) {
+        REQUIRE(report[i - 1].exclusive_time >= report[i].exclusive_time);
+    }
+
+    scheme.ResetProfile();
+    scheme.EnableProfiling(false);
+    scheme.Evaluate("(fib 10)");
+    REQUIRE(scheme.GetProfileReport().empty());
+}
+
+TEST_CASE("ProfileReportBuiltin") {
+    Scheme scheme;
+    REQUIRE(scheme.Evaluate("(profile-report)") == "()");
+
+    scheme.EnableProfiling(true);
+    scheme.Evaluate("(define (f) (car 1))");
+    REQUIRE_THROWS_AS(scheme.Evaluate("(f)"), RuntimeError);
+    REQUIRE(scheme.Evaluate("(list? (profile-report))") == "#t");
+    REQUIRE(scheme.Evaluate("(car (car (profile-report)))") != "()");
+
+    auto report = scheme.GetProfileReport();
+    REQUIRE(Find(report, "f")->calls == 1);
+    REQUIRE(Find(report, "car")->calls == 1);
+    REQUIRE(Find(report, "profile-report")->calls == 2);
+}
+
+TEST_CASE("ProfilerSplitsAllocationsByCaller") {
+    Scheme scheme;
+    scheme.Evaluate("(define (pairs n) (if (= n 0) '() (cons n (pairs (- n 1)))))");
+    scheme.Evaluate("(define (few) (car (pairs 10)))");
+    scheme.Evaluate("(define (many) (car (pairs 1000)))");
+    scheme.EnableProfiling(true);
+    scheme.Evaluate("(few)");
+    scheme.Evaluate("(many)");
+    scheme.Evaluate("(pairs 5)");
+
+    auto report = scheme.GetProfileReport();
+    const auto* pairs = Find(report, "pairs");
+    REQUIRE(pairs->callers.size() == 4);
+    // Собственные выделения рекурсивных вызовов намного больше, чем у трех внешних.
+    REQUIRE(pairs->callers[0].caller == "pairs");
+    REQUIRE(pairs->callers[0].calls == 1'015);
+    for (const auto* caller : {"many", "few", kTopLevelCaller.data()}) {
+        auto it = std::find_if(pairs->callers.begin(), pairs->callers.end(),
+                               [caller](const CallSite& site) { return site.caller == caller; });
+        REQUIRE(it != pairs->callers.end());
+        REQUIRE(it->calls == 1);
+        REQUIRE(it->bytes_allocated > 0);
+        REQUIRE(it->bytes_allocated * 100 < pairs->callers[0].bytes_allocated);
+    }
+    size_t bytes = 0;
+    for (const auto& site : pairs->callers) {
+        bytes += site.bytes_allocated;
+    }
+    REQUIRE(bytes == pairs->bytes_allocated);
+
+    scheme.Evaluate(
+        "(define (index rows t)"
+        "  (if (null? rows) t"
+        "      (begin (hash-set! t (car (car rows)) (car rows)) (index (cdr rows) t))))");
+    scheme.Evaluate("(define rows (index (profile-report) (make-hash-table)))");
+    scheme.Evaluate("(define sites (index (list-ref (hash-ref rows 'pairs) 5) (make-hash-table)))");
+    REQUIRE(scheme.Evaluate("(list-ref (hash-ref sites 'many) 1)") == "1");
+    REQUIRE(scheme.Evaluate("(list-ref (hash-ref sites 'pairs) 1)") == "1015");
+}
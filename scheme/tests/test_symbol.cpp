@@ -1,4 +1,10 @@
 #include <tests/scheme_test.h>
+#include <symbols.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
 
 TEST_CASE_METHOD(SchemeTest, "SymbolsAreNotSelfEvaluating") {
     ExpectNameError("x");
@@ -51,3 +57,26 @@ TEST_CASE_METHOD(SchemeTest, "SetInvalidSyntax") {
     ExpectSyntaxError("(set! 1)");
     ExpectSyntaxError("(set! x 1 2)");
 }
+
+TEST_CASE("SymbolsAreInternedConcurrently") {
+    constexpr auto kThreads = 4;
+    constexpr auto kSymbols = 1000;
+
+    std::vector<std::vector<uint32_t>> ids(kThreads);
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < kThreads; ++i) {
+        threads.emplace_back([&ids, i] {
+            for (auto j = 0; j < kSymbols; ++j) {
+                ids[i].push_back(SymbolTable::Instance().Intern("concurrent-" + std::to_string(j)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    for (auto i = 1; i < kThreads; ++i) {
+        REQUIRE(ids[i] == ids[0]);
+    }
+    REQUIRE(SymbolTable::Instance().GetName(ids[0][42]) == "concurrent-42");
+}
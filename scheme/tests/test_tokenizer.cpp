@@ -0,0 +1,64 @@
+#include <tokenizer.h>
+#include <error.h>
+
+#include <cstdint>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <catch2/catch_test_macros.hpp>
+
+namespace {
+
+std::vector<Token> ReadAll(Tokenizer* tokenizer) {
+    std::vector<Token> tokens;
+    for (; !tokenizer->IsEnd(); tokenizer->Next()) {
+        tokens.push_back(tokenizer->GetToken());
+    }
+    return tokens;
+}
+
+}  // namespace
+
+TEST_CASE("BufferTokenizerMatchesStream") {
+    const std::string source = " (define (f x)\n\t(+ x -12 'sym))  #t .. zog-zog? <=> - +5 ";
+
+    std::istringstream in{source};
+    Tokenizer stream_tokenizer{&in};
+    Tokenizer buffer_tokenizer{std::string_view{source}};
+    auto expected = ReadAll(&stream_tokenizer);
+    auto tokens = ReadAll(&buffer_tokenizer);
+    REQUIRE(tokens == expected);
+    REQUIRE(tokens.size() == 21);
+
+    // Символы из буфера ссылаются на исходный текст.
+    const auto& symbol = std::get<SymbolToken>(tokens[1]);
+    REQUIRE(symbol.name == "define");
+    REQUIRE(symbol.name.data() == source.data() + 2);
+    REQUIRE(symbol.GetId() == std::get<SymbolToken>(expected[1]).GetId());
+}
+
+TEST_CASE("BufferTokenizerErrors") {
+    Tokenizer tokenizer{std::string_view{"(a"}};
+    tokenizer.Next();
+    tokenizer.Next();
+    REQUIRE(tokenizer.IsEnd());
+
+    REQUIRE_THROWS_AS(Tokenizer{std::string_view{"[1]"}}, SyntaxError);
+}
+
+TEST_CASE("TokenizerNumberLiterals") {
+    const std::string source =
+        "2147483648 -9223372036854775808 9223372036854775808 -123456789012345678901";
+
+    std::istringstream in{source};
+    Tokenizer stream_tokenizer{&in};
+    Tokenizer buffer_tokenizer{std::string_view{source}};
+    auto tokens = ReadAll(&buffer_tokenizer);
+    REQUIRE(tokens == ReadAll(&stream_tokenizer));
+    REQUIRE(tokens == std::vector<Token>{ConstantToken{2147483648},
+                                         ConstantToken{std::numeric_limits<int64_t>::min()},
+                                         BignumToken{"9223372036854775808"},
+                                         BignumToken{"-123456789012345678901"}});
+}
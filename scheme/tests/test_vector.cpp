@@ -0,0 +1,76 @@
+#include <tests/scheme_test.h>
+
+TEST_CASE_METHOD(SchemeTest, "Vectors") {
+    ExpectEq("(make-vector 3)", "#(0 0 0)");
+    ExpectEq("(make-vector 2 'a)", "#(a a)");
+    ExpectEq("(make-vector 0)", "#()");
+    ExpectEq("(vector 1 '(2 3) #t)", "#(1 (2 3) #t)");
+    ExpectEq("(vector? (vector))", "#t");
+    ExpectEq("(vector? '(1 2))", "#f");
+
+    ExpectNoError("(define v (make-vector 5 0))");
+    ExpectEq("(vector-length v)", "5");
+    ExpectNoError("(vector-set! v 0 'x)");
+    ExpectNoError("(vector-set! v 4 (vector 1))");
+    ExpectEq("(vector-ref v 0)", "x");
+    ExpectEq("v", "#(x 0 0 0 #(1))");
+
+    ExpectNoError(
+        "(define (fill i)"
+        "  (if (< i 5) (begin (vector-set! v i (* i i)) (fill (+ i 1)))))");
+    ExpectNoError("(fill 0)");
+    ExpectEq("v", "#(0 1 4 9 16)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "VectorErrors") {
+    ExpectNoError("(define v (make-vector 2))");
+    ExpectRuntimeError("(vector-ref v 2)");
+    ExpectRuntimeError("(vector-ref v -1)");
+    ExpectRuntimeError("(vector-set! v 2 0)");
+    ExpectRuntimeError("(vector-ref '(1 2) 0)");
+    ExpectRuntimeError("(vector-ref v #t)");
+    ExpectRuntimeError("(make-vector -1)");
+    ExpectRuntimeError("(make-vector)");
+    ExpectRuntimeError("(make-vector 268435457)");
+    ExpectRuntimeError("(make-vector 68719476736)");
+    ExpectRuntimeError("(make-vector 9223372036854775807)");
+    ExpectRuntimeError("(make-vector 1237940039285380274899124224)");
+    ExpectRuntimeError("(vector-length 1)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTables") {
+    ExpectNoError("(define t (make-hash-table))");
+    ExpectEq("(hash-table? t)", "#t");
+    ExpectEq("(hash-table? (vector))", "#f");
+    ExpectEq("t", "#<hash-table>");
+    ExpectEq("(hash-count t)", "0");
+
+    ExpectNoError("(hash-set! t 'a 1)");
+    ExpectNoError("(hash-set! t -5 '(x y))");
+    ExpectEq("(hash-ref t 'a)", "1");
+    ExpectEq("(hash-ref t -5)", "(x y)");
+    ExpectEq("(hash-ref t 'b #f)", "#f");
+    ExpectNoError("(hash-set! t 'a 2)");
+    ExpectEq("(hash-ref t 'a)", "2");
+    ExpectEq("(hash-count t)", "2");
+
+    ExpectRuntimeError("(hash-ref t 'b)");
+    ExpectRuntimeError("(hash-set! t '(1) 0)");
+    ExpectRuntimeError("(hash-ref t #t 0)");
+    ExpectRuntimeError("(hash-ref (vector) 'a)");
+}
+
+TEST_CASE_METHOD(SchemeTest, "HashTableGrows") {
+    ExpectNoError("(define t (make-hash-table))");
+    ExpectNoError(
+        "(define (fill i n)"
+        "  (if (< i n) (begin (hash-set! t i (* i i)) (fill (+ i 1) n))))");
+    ExpectNoError("(fill 0 10000)");
+    ExpectEq("(hash-count t)", "10000");
+    ExpectEq("(hash-ref t 9999)", "99980001");
+    ExpectEq("(hash-ref t -1 'none)", "none");
+    ExpectNoError(
+        "(define (check i)"
+        "  (if (= i 10000) #t (and (= (hash-ref t i) (* i i)) (check (+ i 1)))))");
+    ExpectEq("(check 0)", "#t");
+}
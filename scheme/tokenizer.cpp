@@ -0,0 +1,186 @@
+#include <tokenizer.h>
+#include <error.h>
+#include <symbols.h>
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <utility>
+
+namespace {
+
+constexpr uint8_t kSpace = 1 << 0;
+constexpr uint8_t kDigit = 1 << 1;
+constexpr uint8_t kSymbolStart = 1 << 2;
+constexpr uint8_t kSymbolInner = 1 << 3;
+
+constexpr auto kCharClasses = [] {
+    std::array<uint8_t, 256> classes{};
+    for (auto c : {' ', '\t', '\n', '\v', '\f', '\r'}) {
+        classes[c] = kSpace;
+    }
+    for (auto c = '0'; c <= '9'; ++c) {
+        classes[c] = kDigit | kSymbolInner;
+    }
+    for (auto c = 'a'; c <= 'z'; ++c) {
+        classes[c] = classes[c - 'a' + 'A'] = kSymbolStart | kSymbolInner;
+    }
+    for (auto c : {'<', '=', '>', '*', '/', '#'}) {
+        classes[c] = kSymbolStart | kSymbolInner;
+    }
+    for (auto c : {'?', '!', '-'}) {
+        classes[c] = kSymbolInner;
+    }
+    return classes;
+}();
+
+// c - результат peek(), то есть unsigned char или EOF.
+bool HasClass(int c, uint8_t char_class) {
+    return c >= 0 && (kCharClasses[c] & char_class);
+}
+
+}  // namespace
+
+SymbolToken::SymbolToken(std::string_view name) : name{name} {
+}
+
+SymbolToken::SymbolToken(std::string_view name, uint32_t id) : name{name}, id_{id} {
+}
+
+uint32_t SymbolToken::GetId() const {
+    return id_ != kNoId ? id_ : SymbolTable::Instance().Intern(name);
+}
+
+bool SymbolToken::operator==(const SymbolToken& other) const {
+    return name == other.name;
+}
+
+bool QuoteToken::operator==(const QuoteToken&) const {
+    return true;
+}
+
+bool DotToken::operator==(const DotToken&) const {
+    return true;
+}
+
+bool ConstantToken::operator==(const ConstantToken& other) const {
+    return value == other.value;
+}
+
+bool BignumToken::operator==(const BignumToken& other) const {
+    return digits == other.digits;
+}
+
+Tokenizer::Tokenizer(std::istream* in) : in_{in} {
+    Next();
+}
+
+Tokenizer::Tokenizer(std::string_view source) : source_{source} {
+    Next();
+}
+
+bool Tokenizer::IsEnd() {
+    return is_end_;
+}
+
+void Tokenizer::Next() {
+    while (HasClass(Peek(), kSpace)) {
+        Get();
+    }
+
+    auto symbol = Peek();
+    if (symbol == std::char_traits<char>::eof()) {
+        is_end_ = true;
+        return;
+    }
+
+    Get();
+    if (symbol == '(') {
+        token_ = BracketToken::OPEN;
+    } else if (symbol == ')') {
+        token_ = BracketToken::CLOSE;
+    } else if (symbol == '\'') {
+        token_ = QuoteToken{};
+    } else if (symbol == '.') {
+        token_ = DotToken{};
+    } else if (HasClass(symbol, kDigit)) {
+        ReadNumber(1, symbol - '0');
+    } else if (symbol == '+' || symbol == '-') {
+        if (HasClass(Peek(), kDigit)) {
+            ReadNumber(symbol == '+' ? 1 : -1, 0);
+        } else {
+            token_ = SymbolToken{symbol == '+' ? "+" : "-"};
+        }
+    } else if (HasClass(symbol, kSymbolStart)) {
+        ReadSymbol(static_cast<char>(symbol));
+    } else {
+        throw SyntaxError{"Unexpected character: " + std::string(1, static_cast<char>(symbol))};
+    }
+}
+
+Token Tokenizer::GetToken() {
+    return token_;
+}
+
+int Tokenizer::Peek() {
+    if (in_) {
+        return in_->peek();
+    }
+    return pos_ < source_.size() ? static_cast<unsigned char>(source_[pos_])
+                                 : std::char_traits<char>::eof();
+}
+
+int Tokenizer::Get() {
+    if (in_) {
+        return in_->get();
+    }
+    return static_cast<unsigned char>(source_[pos_++]);
+}
+
+// Литерал копится в int64_t, а когда перестает в него помещаться, дочитывается цифрами
+// в BignumToken.
+void Tokenizer::ReadNumber(int sign, int value) {
+    int64_t result = sign * value;
+    while (HasClass(Peek(), kDigit)) {
+        auto digit = Peek() - '0';
+        int64_t next;
+        if (__builtin_mul_overflow(result, 10, &next) ||
+            __builtin_add_overflow(next, sign * digit, &next)) {
+            ReadBignum(result);
+            return;
+        }
+        Get();
+        result = next;
+    }
+    token_ = ConstantToken{result};
+}
+
+// Переполнение случается только на длинном префиксе, так что его запись уже содержит знак.
+void Tokenizer::ReadBignum(int64_t prefix) {
+    BignumToken token{std::to_string(prefix)};
+    while (HasClass(Peek(), kDigit)) {
+        token.digits += static_cast<char>(Get());
+    }
+    token_ = std::move(token);
+}
+
+// Из буфера символ берется как участок исходного текста и интернируется только по запросу.
+// Из потока имя приходится собрать и сразу интернировать, чтобы было где его хранить.
+void Tokenizer::ReadSymbol(char first) {
+    if (!in_) {
+        auto start = pos_ - 1;
+        while (pos_ < source_.size() && HasClass(Peek(), kSymbolInner)) {
+            ++pos_;
+        }
+        token_ = SymbolToken{source_.substr(start, pos_ - start)};
+        return;
+    }
+
+    std::string name(1, first);
+    while (HasClass(in_->peek(), kSymbolInner)) {
+        name += static_cast<char>(in_->get());
+    }
+    auto id = SymbolTable::Instance().Intern(name);
+    token_ = SymbolToken{SymbolTable::Instance().GetName(id), id};
+}
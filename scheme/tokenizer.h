@@ -1,12 +1,29 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <variant>
 #include <istream>
+#include <limits>
+#include <string>
+#include <string_view>
 
+// name ссылается либо на исходный буфер токенизатора, либо на имя в SymbolTable.
 struct SymbolToken {
-    std::string name;
+    explicit SymbolToken(std::string_view name);
+    SymbolToken(std::string_view name, uint32_t id);
+
+    // Номер в SymbolTable. Если токенизатор не интернировал имя сам, это делается здесь.
+    uint32_t GetId() const;
 
     bool operator==(const SymbolToken& other) const;
+
+    std::string_view name;
+
+private:
+    static constexpr uint32_t kNoId = std::numeric_limits<uint32_t>::max();
+
+    uint32_t id_ = kNoId;
 };
 
 struct QuoteToken {
@@ -20,21 +37,45 @@ struct DotToken {
 enum class BracketToken { OPEN, CLOSE };
 
 struct ConstantToken {
-    int value;
+    int64_t value;
 
     bool operator==(const ConstantToken& other) const;
 };
 
-using Token = std::variant<ConstantToken, BracketToken, SymbolToken, QuoteToken, DotToken>;
+// Литерал, который не помещается в int64_t: знак, если он был, и десятичные цифры.
+struct BignumToken {
+    std::string digits;
+
+    bool operator==(const BignumToken& other) const;
+};
+
+using Token =
+    std::variant<ConstantToken, BignumToken, BracketToken, SymbolToken, QuoteToken, DotToken>;
 
 // Интерфейс позволяющий читать токены по одному из потока.
+// Второй режим работает над непрерывным буфером: символы в токенах ссылаются на него,
+// поэтому буфер должен жить дольше токенов.
 class Tokenizer {
 public:
     Tokenizer(std::istream* in);
+    explicit Tokenizer(std::string_view source);
 
     bool IsEnd();
 
     void Next();
 
     Token GetToken();
+
+private:
+    int Peek();
+    int Get();
+    void ReadNumber(int sign, int value);
+    void ReadBignum(int64_t prefix);
+    void ReadSymbol(char first);
+
+    std::istream* in_ = nullptr;
+    std::string_view source_;
+    size_t pos_ = 0;
+    Token token_;
+    bool is_end_ = false;
 };
@@ -0,0 +1,76 @@
+#include <value.h>
+#include <hash_table.h>
+#include <numbers.h>
+#include <procedure.h>
+#include <symbols.h>
+
+#include <sstream>
+
+namespace {
+
+void Print(std::ostream& out, Value value);
+
+void PrintList(std::ostream& out, const Pair& pair) {
+    out << '(';
+    Print(out, pair.first);
+    auto tail = pair.second;
+    while (const auto* next = tail.As<Pair>()) {
+        out << ' ';
+        Print(out, next->first);
+        tail = next->second;
+    }
+    if (!tail.IsNil()) {
+        out << " . ";
+        Print(out, tail);
+    }
+    out << ')';
+}
+
+void Print(std::ostream& out, Value value) {
+    if (value.IsFixnum()) {
+        out << value.GetFixnum();
+    } else if (value.IsBool()) {
+        out << (value.GetBool() ? "#t" : "#f");
+    } else if (value.IsSymbol()) {
+        out << SymbolTable::Instance().GetName(value.GetSymbol());
+    } else if (value.IsNil()) {
+        out << "()";
+    } else if (value.Is<Bignum>()) {
+        out << NumberToString(value);
+    } else if (const auto* pair = value.As<Pair>()) {
+        PrintList(out, *pair);
+    } else if (const auto* vector = value.As<Vector>()) {
+        out << "#(";
+        for (size_t i = 0; i < vector->size; ++i) {
+            if (i > 0) {
+                out << ' ';
+            }
+            Print(out, vector->Elements()[i]);
+        }
+        out << ')';
+    } else if (value.Is<HashTable>()) {
+        out << "#<hash-table>";
+    } else if (const auto* builtin = value.As<Builtin>()) {
+        out << "#<procedure " << builtin->name << '>';
+    } else if (const auto* closure = value.As<Closure>()) {
+        out << "#<procedure " << closure->code->name << '>';
+    } else {
+        out << "#<object>";
+    }
+}
+
+}  // namespace
+
+bool IsTrue(Value value) {
+    return !value.IsFalse();
+}
+
+bool IsProcedure(Value value) {
+    return value.Is<Builtin>() || value.Is<Closure>();
+}
+
+std::string ToString(Value value) {
+    std::ostringstream out;
+    Print(out, value);
+    return out.str();
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+
+// Объекты времени выполнения живут в куче со сборкой мусора (см. heap.h),
+// AST из парсера - отдельно, в std::shared_ptr.
+enum class ObjectType : uint8_t {
+    kFree,
+    kPair,
+    kBuiltin,
+    kClosure,
+    kEnvironment,
+    kCode,
+    kBignum,
+    kVector,
+    kHashTable,
+};
+
+struct HeapObject {
+    explicit HeapObject(ObjectType type) : type{type} {
+    }
+
+    ObjectType type;
+    bool marked = false;
+    // Объект замороженной кучи (см. Heap::Freeze): изменять его нельзя.
+    bool frozen = false;
+};
+
+// Значение - 64-битное слово, тип которого записан в младших битах:
+//   ...000 - указатель на объект кучи, 0 - пустой список;
+//   ...xx1 - целое число (fixnum) в старших 63 битах, большие числа - Bignum в куче;
+//   ...010 - символ, в старших битах его номер в SymbolTable;
+//   ...100 - #f или #t.
+// Числа, булевы значения и символы не требуют выделения памяти.
+class Value {
+public:
+    static constexpr int64_t kMinFixnum = -(int64_t{1} << 62);
+    static constexpr int64_t kMaxFixnum = (int64_t{1} << 62) - 1;
+
+    Value() = default;
+
+    Value(HeapObject* object) : bits_{reinterpret_cast<uintptr_t>(object)} {
+    }
+
+    static bool FitsFixnum(int64_t value) {
+        return value >= kMinFixnum && value <= kMaxFixnum;
+    }
+
+    // value должно помещаться в fixnum, иначе см. MakeInteger из numbers.h.
+    static Value MakeFixnum(int64_t value) {
+        return Value{(static_cast<uint64_t>(value) << 1) | kFixnumTag};
+    }
+
+    static Value MakeBool(bool value) {
+        return Value{value ? kTrueBits : kFalseBits};
+    }
+
+    static Value MakeSymbol(uint32_t id) {
+        return Value{(static_cast<uint64_t>(id) << kTagBits) | kSymbolTag};
+    }
+
+    bool IsNil() const {
+        return !bits_;
+    }
+
+    bool IsFixnum() const {
+        return bits_ & kFixnumTag;
+    }
+
+    bool IsBool() const {
+        return (bits_ & kTagMask) == kBoolTag;
+    }
+
+    bool IsSymbol() const {
+        return (bits_ & kTagMask) == kSymbolTag;
+    }
+
+    bool IsFalse() const {
+        return bits_ == kFalseBits;
+    }
+
+    int64_t GetFixnum() const {
+        return static_cast<int64_t>(bits_) >> 1;
+    }
+
+    bool GetBool() const {
+        return bits_ == kTrueBits;
+    }
+
+    uint32_t GetSymbol() const {
+        return static_cast<uint32_t>(bits_ >> kTagBits);
+    }
+
+    // nullptr для пустого списка и непосредственных значений.
+    HeapObject* GetObject() const {
+        return (bits_ & kTagMask) ? nullptr : reinterpret_cast<HeapObject*>(bits_);
+    }
+
+    template <class T>
+    T* As() const {
+        auto* object = GetObject();
+        return object && object->type == T::kType ? static_cast<T*>(object) : nullptr;
+    }
+
+    template <class T>
+    bool Is() const {
+        return As<T>();
+    }
+
+    bool operator==(const Value& other) const = default;
+
+private:
+    static constexpr uint64_t kTagBits = 3;
+    static constexpr uint64_t kTagMask = (1 << kTagBits) - 1;
+    static constexpr uint64_t kFixnumTag = 0b001;
+    static constexpr uint64_t kSymbolTag = 0b010;
+    static constexpr uint64_t kBoolTag = 0b100;
+    static constexpr uint64_t kFalseBits = kBoolTag;
+    static constexpr uint64_t kTrueBits = (1 << kTagBits) | kBoolTag;
+
+    explicit Value(uint64_t bits) : bits_{bits} {
+    }
+
+    uint64_t bits_ = 0;
+};
+
+struct Pair : HeapObject {
+    static constexpr auto kType = ObjectType::kPair;
+
+    Pair(Value first, Value second) : HeapObject{kType}, first{first}, second{second} {
+    }
+
+    Value first;
+    Value second;
+};
+
+// Кадр лексического окружения; слоты лежат сразу за объектом.
+struct Environment : HeapObject {
+    static constexpr auto kType = ObjectType::kEnvironment;
+
+    Environment(Environment* parent, size_t size) : HeapObject{kType}, parent{parent}, size{size} {
+        for (size_t i = 0; i < size; ++i) {
+            new (Slots() + i) Value{};
+        }
+    }
+
+    Value* Slots() {
+        return reinterpret_cast<Value*>(this + 1);
+    }
+
+    const Value* Slots() const {
+        return reinterpret_cast<const Value*>(this + 1);
+    }
+
+    Environment* parent;
+    size_t size;
+};
+
+// Элементы лежат сразу за объектом, как слоты Environment.
+struct Vector : HeapObject {
+    static constexpr auto kType = ObjectType::kVector;
+
+    Vector(size_t size, Value fill) : HeapObject{kType}, size{size} {
+        for (size_t i = 0; i < size; ++i) {
+            new (Elements() + i) Value{fill};
+        }
+    }
+
+    Value* Elements() {
+        return reinterpret_cast<Value*>(this + 1);
+    }
+
+    const Value* Elements() const {
+        return reinterpret_cast<const Value*>(this + 1);
+    }
+
+    size_t size;
+};
+
+// Модуль числа в 32-битных разрядах от младших к старшим, лежат сразу за объектом.
+// Старший разряд не нулевой, и число всегда больше любого fixnum по модулю.
+struct Bignum : HeapObject {
+    static constexpr auto kType = ObjectType::kBignum;
+
+    Bignum(bool negative, size_t size) : HeapObject{kType}, negative{negative}, size{size} {
+    }
+
+    uint32_t* Limbs() {
+        return reinterpret_cast<uint32_t*>(this + 1);
+    }
+
+    const uint32_t* Limbs() const {
+        return reinterpret_cast<const uint32_t*>(this + 1);
+    }
+
+    bool negative;
+    size_t size;
+};
+
+bool IsTrue(Value value);
+
+bool IsProcedure(Value value);
+
+std::string ToString(Value value);
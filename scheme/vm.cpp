@@ -0,0 +1,308 @@
+#include <vm.h>
+#include <error.h>
+
+#include <span>
+#include <utility>
+
+namespace {
+
+Environment* GetFrame(Environment* env, size_t depth) {
+    for (; depth > 0; --depth) {
+        env = env->parent;
+    }
+    return env;
+}
+
+// Быстрый путь для самого частого случая: два числа. Остальное считает сама встроенная функция.
+Value TryArithmetic(OpCode op, std::span<const Value> args, bool* done) {
+    *done = false;
+    if (args.size() != 2) {
+        return {};
+    }
+    if (!args[0].IsFixnum() || !args[1].IsFixnum()) {
+        return {};
+    }
+    auto a = args[0].GetFixnum();
+    auto b = args[1].GetFixnum();
+    // Переполнение fixnum и деление на ноль тоже уходят во встроенную функцию.
+    int64_t result;
+    switch (op) {
+        case OpCode::kAdd:
+            result = a + b;
+            break;
+        case OpCode::kSub:
+            result = a - b;
+            break;
+        case OpCode::kMul:
+            if (__builtin_mul_overflow(a, b, &result)) {
+                return {};
+            }
+            break;
+        case OpCode::kDiv:
+            if (b == 0) {
+                return {};
+            }
+            result = a / b;
+            break;
+        case OpCode::kNumEqual:
+            *done = true;
+            return Value::MakeBool(a == b);
+        case OpCode::kLess:
+            *done = true;
+            return Value::MakeBool(a < b);
+        case OpCode::kGreater:
+            *done = true;
+            return Value::MakeBool(a > b);
+        case OpCode::kLessEqual:
+            *done = true;
+            return Value::MakeBool(a <= b);
+        case OpCode::kGreaterEqual:
+            *done = true;
+            return Value::MakeBool(a >= b);
+        default:
+            return {};
+    }
+    *done = Value::FitsFixnum(result);
+    return *done ? Value::MakeFixnum(result) : Value{};
+}
+
+}  // namespace
+
+VirtualMachine::VirtualMachine(Heap* heap, Globals* globals) : heap_{heap}, globals_{globals} {
+    heap_->AddRootSet(this);
+}
+
+VirtualMachine::~VirtualMachine() {
+    heap_->RemoveRootSet(this);
+}
+
+Value VirtualMachine::Run(Code* code) {
+    stack_.clear();
+    frames_.clear();
+    frames_.push_back({code, code->instructions.data(), nullptr});
+    if (!profiler_) {
+        return Execute();
+    }
+    // Кадр верхнего уровня профилировщику не сообщается, поэтому вызов, заменивший его
+    // хвостовым, и вызовы, прерванные исключением, закрываются здесь.
+    try {
+        auto result = Execute();
+        profiler_->Unwind();
+        return result;
+    } catch (...) {
+        profiler_->Unwind();
+        throw;
+    }
+}
+
+Value VirtualMachine::Execute() {
+    while (true) {
+        if (heap_->ShouldCollect()) {
+            heap_->CollectStep();
+        }
+
+        auto& frame = frames_.back();
+        const auto& instruction = *frame.pc++;
+        switch (instruction.op) {
+            case OpCode::kConst:
+                stack_.push_back(frame.code->constants[instruction.index]);
+                break;
+            case OpCode::kLoadLocal:
+                stack_.push_back(
+                    GetFrame(frame.env, instruction.count)->Slots()[instruction.index]);
+                break;
+            case OpCode::kStoreLocal: {
+                auto* env = GetFrame(frame.env, instruction.count);
+                if (env->frozen) {
+                    throw RuntimeError{"Cannot modify an immutable object"};
+                }
+                heap_->WriteBarrier(stack_.back());
+                env->Slots()[instruction.index] = std::exchange(stack_.back(), Value{});
+                break;
+            }
+            case OpCode::kLoadGlobal:
+                stack_.push_back(globals_->Get(instruction.index));
+                break;
+            case OpCode::kStoreGlobal:
+                globals_->Set(instruction.index, std::exchange(stack_.back(), Value{}));
+                break;
+            case OpCode::kDefineGlobal:
+                globals_->Define(instruction.index, std::exchange(stack_.back(), Value{}));
+                break;
+            case OpCode::kPop:
+                stack_.pop_back();
+                break;
+            case OpCode::kJump:
+                frame.pc = frame.code->instructions.data() + instruction.index;
+                break;
+            case OpCode::kJumpIfFalse: {
+                auto condition = IsTrue(stack_.back());
+                stack_.pop_back();
+                if (!condition) {
+                    frame.pc = frame.code->instructions.data() + instruction.index;
+                }
+                break;
+            }
+            case OpCode::kJumpIfFalseOrPop:
+                if (!IsTrue(stack_.back())) {
+                    frame.pc = frame.code->instructions.data() + instruction.index;
+                } else {
+                    stack_.pop_back();
+                }
+                break;
+            case OpCode::kJumpIfTrueOrPop:
+                if (IsTrue(stack_.back())) {
+                    frame.pc = frame.code->instructions.data() + instruction.index;
+                } else {
+                    stack_.pop_back();
+                }
+                break;
+            case OpCode::kMakeClosure:
+                stack_.push_back(
+                    heap_->Make<Closure>(frame.code->children[instruction.index], frame.env));
+                break;
+            case OpCode::kCall:
+                Call(instruction.count, false);
+                break;
+            case OpCode::kTailCall:
+                Call(instruction.count, true);
+                break;
+            case OpCode::kReturn: {
+                frames_.pop_back();
+                if (frames_.empty()) {
+                    auto result = stack_.back();
+                    stack_.clear();
+                    return result;
+                }
+                if (profiler_) {
+                    profiler_->Exit();
+                }
+                break;
+            }
+            case OpCode::kIllFormed:
+                throw SyntaxError{"Improper list in procedure call"};
+            default:
+                CallPrimitive(instruction);
+                break;
+        }
+    }
+}
+
+void VirtualMachine::SetMaxDepth(size_t max_depth) {
+    max_depth_ = max_depth;
+}
+
+void VirtualMachine::SetProfiler(Profiler* profiler) {
+    profiler_ = profiler;
+}
+
+void VirtualMachine::TraceRoots(Heap* heap) {
+    for (auto value : stack_) {
+        heap->Mark(value);
+    }
+    for (const auto& frame : frames_) {
+        heap->Mark(frame.code);
+        heap->Mark(frame.env);
+    }
+}
+
+void VirtualMachine::Call(size_t argc, bool tail) {
+    auto base = stack_.size() - argc;
+    auto callee = stack_[base - 1];
+
+    if (const auto* closure = callee.As<Closure>()) {
+        auto* code = closure->code;
+        if (argc < code->param_count || (!code->variadic && argc > code->param_count)) {
+            throw RuntimeError{"Wrong number of arguments for " + code->name};
+        }
+        if (profiler_) {
+            if (tail) {
+                profiler_->Exit();
+            }
+            profiler_->Enter(code->name);
+        }
+
+        auto* env = heap_->MakeEnvironment(closure->env, code->slot_count);
+        for (size_t i = 0; i < code->param_count; ++i) {
+            env->Slots()[i] = stack_[base + i];
+        }
+        if (code->variadic) {
+            Value rest;
+            for (auto i = argc; i > code->param_count; --i) {
+                rest = heap_->MakePair(stack_[base + i - 1], rest);
+            }
+            env->Slots()[code->param_count] = rest;
+        }
+
+        stack_.resize(base - 1);
+        if (tail) {
+            frames_.back() = {code, code->instructions.data(), env};
+        } else if (frames_.size() < max_depth_) {
+            frames_.push_back({code, code->instructions.data(), env});
+        } else {
+            throw RuntimeError{"Maximum recursion depth exceeded"};
+        }
+    } else if (const auto* builtin = callee.As<Builtin>()) {
+        auto result = CallBuiltin(builtin, {stack_.data() + base, argc});
+        stack_.resize(base - 1);
+        stack_.push_back(result);
+    } else {
+        throw RuntimeError{"Not a procedure: " + ToString(callee)};
+    }
+}
+
+Value VirtualMachine::CallBuiltin(const Builtin* builtin, std::span<const Value> args) {
+    if (!profiler_) {
+        return builtin->function(heap_, args);
+    }
+    profiler_->Enter(builtin->name);
+    auto result = builtin->function(heap_, args);
+    profiler_->Exit();
+    return result;
+}
+
+void VirtualMachine::CallPrimitive(const Instruction& instruction) {
+    size_t argc = instruction.count;
+    auto base = stack_.size() - argc;
+
+    if (!globals_->IsBuiltin(instruction.index)) {
+        stack_.insert(stack_.begin() + base, globals_->Get(instruction.index));
+        Call(argc, frames_.back().pc->op == OpCode::kReturn);
+        return;
+    }
+
+    std::span<const Value> args{stack_.data() + base, argc};
+    Value result;
+    auto done = true;
+    switch (instruction.op) {
+        case OpCode::kNot:
+            result = Value::MakeBool(!IsTrue(args[0]));
+            break;
+        case OpCode::kIsNull:
+            result = Value::MakeBool(args[0].IsNil());
+            break;
+        case OpCode::kIsPair:
+            result = Value::MakeBool(args[0].Is<Pair>());
+            break;
+        case OpCode::kCons:
+            result = heap_->MakePair(args[0], args[1]);
+            break;
+        case OpCode::kCar:
+        case OpCode::kCdr:
+            if (const auto* pair = args[0].As<Pair>()) {
+                result = instruction.op == OpCode::kCar ? pair->first : pair->second;
+            } else {
+                done = false;
+            }
+            break;
+        default:
+            result = TryArithmetic(instruction.op, args, &done);
+            break;
+    }
+    if (!done) {
+        result = CallBuiltin(globals_->Get(instruction.index).As<Builtin>(), args);
+    }
+
+    stack_.resize(base);
+    stack_.push_back(result);
+}
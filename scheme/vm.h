@@ -0,0 +1,59 @@
+#pragma once
+
+#include <value.h>
+#include <bytecode.h>
+#include <globals.h>
+#include <heap.h>
+#include <procedure.h>
+#include <profiler.h>
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Стековая машина. Вызовы замыканий не используют стек C++: каждому вызову
+// соответствует запись в frames_, аргументы и промежуточные значения лежат в stack_.
+// Хвостовой вызов заменяет текущую запись, так что циклы на хвостовой рекурсии работают
+// в постоянной памяти. Между инструкциями все живые значения достижимы из стеков,
+// поэтому там же запускается сборка мусора.
+class VirtualMachine : public RootSet {
+public:
+    static constexpr size_t kDefaultMaxDepth = 1 << 20;
+
+    VirtualMachine(Heap* heap, Globals* globals);
+    ~VirtualMachine();
+
+    VirtualMachine(const VirtualMachine&) = delete;
+    VirtualMachine& operator=(const VirtualMachine&) = delete;
+
+    Value Run(Code* code);
+
+    // Глубже max_depth нехвостовых вызовов - RuntimeError.
+    void SetMaxDepth(size_t max_depth);
+
+    // Вызовы замыканий и встроенных функций сообщаются профилировщику; nullptr - отключен.
+    // Примитивы, подставленные компилятором, считаются вызовами, только если ушли
+    // на медленный путь.
+    void SetProfiler(Profiler* profiler);
+
+    void TraceRoots(Heap* heap) override;
+
+private:
+    struct CallFrame {
+        Code* code;
+        const Instruction* pc;
+        Environment* env;
+    };
+
+    Value Execute();
+    void Call(size_t argc, bool tail);
+    Value CallBuiltin(const Builtin* builtin, std::span<const Value> args);
+    void CallPrimitive(const Instruction& instruction);
+
+    std::vector<Value> stack_;
+    std::vector<CallFrame> frames_;
+    Heap* heap_;
+    Globals* globals_;
+    size_t max_depth_ = kDefaultMaxDepth;
+    Profiler* profiler_ = nullptr;
+};